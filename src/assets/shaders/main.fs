@@ -5,23 +5,27 @@
 
 uniform mat4 MVP;
 
-uniform struct Light {
+struct Light {
     vec3 direction;
     vec3 ambient;
     vec3 diffuse;
     vec3 specular;
-} light;
+};
 
-uniform struct Material {
+layout(std140) uniform FrameBlock {  // updated once per frame
+    Light light;
+};
+
+layout(std140) uniform MaterialBlock {  // a range of the material buffer
     vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
     float shininess;
-
+    vec3 diffuse;
     bool isTextured;
-    sampler2D texture;
+    vec3 specular;
 } material;
 
+uniform sampler2D materialTexture;
+
 in vec3 position;
 in vec3 normal;
 in vec2 texcoords;
@@ -42,5 +46,5 @@ vec4 getLightColor() {
 
 void main() {
     gl_FragColor = getLightColor() *
-        ((material.isTextured) ? texture2D(material.texture, pixelTexCoord) : vec4(1.0, 1.0, 1.0, 1.0));
+        ((material.isTextured) ? texture2D(materialTexture, pixelTexCoord) : vec4(1.0, 1.0, 1.0, 1.0));
 }
@@ -2,24 +2,36 @@
 // Copyright 2020 Bastian Kuolt
 uniform mat4 MVP;
 
-uniform struct Light {
-    vec3 direction;
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-} light;
+uniform struct VertexFormat {
+    vec3 offset;      // of the quantized positions
+    vec3 scale;
+    bool octahedral;  // normals are octahedral encoded
+    vec2 texcoordOffset;  // of the quantized texture coordinates
+    vec2 texcoordScale;
+} vertexFormat;
 
-in vec3 position;
-in vec3 normal;
-in vec2 texcoords;
+layout(location = 0) in vec3 position;  // shared with main_indirect.vs
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoords;
 
 out vec3 pixelNormal;
 out vec2 pixelTexCoord;
 out gl_PerVertex { vec4 gl_Position; };
 
 
+vec3 decodeNormal(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(encoded.x < 0.0 ? -1.0 : 1.0, encoded.y < 0.0 ? -1.0 : 1.0);
+    }
+    return normalize(n);
+}
+
 void main() {
-    gl_Position = MVP * vec4(position, 1.0);
-    pixelNormal = normalize(mat3(MVP) * normal);
-    pixelTexCoord = texcoords;
+    vec3 modelPosition = vertexFormat.offset + vertexFormat.scale * position;
+    vec3 modelNormal = vertexFormat.octahedral ? decodeNormal(normal.xy) : normal;
+
+    gl_Position = MVP * vec4(modelPosition, 1.0);
+    pixelNormal = normalize(mat3(MVP) * modelNormal);
+    pixelTexCoord = vertexFormat.texcoordOffset + vertexFormat.texcoordScale * texcoords;
 }
@@ -0,0 +1,49 @@
+#version 450 core
+// Copyright 2020 Bastian Kuolt
+
+struct Light {
+    vec3 direction;
+    vec3 ambient;
+    vec3 diffuse;
+    vec3 specular;
+};
+
+layout(std140) uniform FrameBlock {  // updated once per frame
+    Light light;
+};
+
+struct Material {  // same layout as MaterialBlock in main.fs
+    vec3 ambient;
+    float shininess;
+    vec3 diffuse;
+    uint isTextured;
+    vec3 specular;
+};
+
+layout(std430, binding = 1) readonly buffer MaterialBuffer {
+    Material materials[];
+};
+
+uniform sampler2D materialTexture;  // the same for all draws of a batch
+
+in vec3 pixelNormal;
+in vec2 pixelTexCoord;
+flat in uint pixelMaterial;
+
+out vec4 fragColor;
+
+
+float calculateLightIntensity() {
+    return max(dot(light.direction, normalize(pixelNormal)), 0.0);
+}
+
+vec4 getLightColor() {
+    vec3 color = light.ambient;
+    color += light.diffuse * calculateLightIntensity() * 0.8;
+    return vec4(color, 0.0);
+}
+
+void main() {
+    fragColor = getLightColor() *
+        ((materials[pixelMaterial].isTextured != 0u) ? texture(materialTexture, pixelTexCoord) : vec4(1.0, 1.0, 1.0, 1.0));
+}
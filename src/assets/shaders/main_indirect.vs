@@ -0,0 +1,46 @@
+#version 450 core
+// Copyright 2020 Bastian Kuolt
+#extension GL_ARB_shader_draw_parameters : require
+uniform mat4 MVP;
+
+struct DrawData {
+    vec3 offset;      // of the quantized positions
+    uint material;    // index into the materials
+    vec3 scale;
+    uint octahedral;  // normals are octahedral encoded
+    vec2 texcoordOffset;  // of the quantized texture coordinates
+    vec2 texcoordScale;
+};
+
+layout(std430, binding = 0) readonly buffer DrawBuffer {
+    DrawData draws[];  // indexed by the base instance of a draw
+};
+
+layout(location = 0) in vec3 position;  // shared with main.vs
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoords;
+
+out vec3 pixelNormal;
+out vec2 pixelTexCoord;
+flat out uint pixelMaterial;
+out gl_PerVertex { vec4 gl_Position; };
+
+
+vec3 decodeNormal(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(encoded.x < 0.0 ? -1.0 : 1.0, encoded.y < 0.0 ? -1.0 : 1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    DrawData draw = draws[gl_BaseInstanceARB];
+    vec3 modelPosition = draw.offset + draw.scale * position;
+    vec3 modelNormal = draw.octahedral != 0u ? decodeNormal(normal.xy) : normal;
+
+    gl_Position = MVP * vec4(modelPosition, 1.0);
+    pixelNormal = normalize(mat3(MVP) * modelNormal);
+    pixelTexCoord = draw.texcoordOffset + draw.texcoordScale * texcoords;
+    pixelMaterial = draw.material;
+}
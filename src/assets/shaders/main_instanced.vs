@@ -0,0 +1,39 @@
+#version 450 core
+// Copyright 2020 Bastian Kuolt
+uniform mat4 VP;
+
+uniform struct VertexFormat {
+    vec3 offset;      // of the quantized positions
+    vec3 scale;
+    bool octahedral;  // normals are octahedral encoded
+    vec2 texcoordOffset;  // of the quantized texture coordinates
+    vec2 texcoordScale;
+} vertexFormat;
+
+layout(location = 0) in vec3 position;  // shared with main.vs
+layout(location = 1) in vec3 normal;
+layout(location = 2) in vec2 texcoords;
+layout(location = 3) in mat4 model;     // per instance, locations 3 to 6
+
+out vec3 pixelNormal;
+out vec2 pixelTexCoord;
+out gl_PerVertex { vec4 gl_Position; };
+
+
+vec3 decodeNormal(vec2 encoded) {
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if (n.z < 0.0) {
+        n.xy = (1.0 - abs(n.yx)) * vec2(encoded.x < 0.0 ? -1.0 : 1.0, encoded.y < 0.0 ? -1.0 : 1.0);
+    }
+    return normalize(n);
+}
+
+void main() {
+    vec3 modelPosition = vertexFormat.offset + vertexFormat.scale * position;
+    vec3 modelNormal = vertexFormat.octahedral ? decodeNormal(normal.xy) : normal;
+    mat4 MVP = VP * model;
+
+    gl_Position = MVP * vec4(modelPosition, 1.0);
+    pixelNormal = normalize(mat3(MVP) * modelNormal);
+    pixelTexCoord = vertexFormat.texcoordOffset + vertexFormat.texcoordScale * texcoords;
+}
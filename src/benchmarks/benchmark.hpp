@@ -0,0 +1,61 @@
+/**
+ * @file benchmark.hpp
+ * @brief Timing of the standalone benchmarks.
+ */
+#ifndef BENCHMARKS_BENCHMARK_HPP_
+#define BENCHMARKS_BENCHMARK_HPP_
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace bgl::benchmark {
+
+/**
+ * @brief Wall clock times of the runs of a benchmark in milliseconds.
+ */
+struct Result {
+    double min;
+    double median;
+    double max;
+};
+
+/**
+ * @brief Runs a function a number of times and measures each run with a steady clock.
+ */
+template<typename Function>
+Result Measure(int runs, Function &&function) {
+    std::vector<double> times;
+    for (int run = 0; run < runs; ++run) {
+        const auto begin { std::chrono::steady_clock::now() };
+        function();
+        const auto end { std::chrono::steady_clock::now() };
+        times.push_back(std::chrono::duration<double, std::milli> { end - begin }.count());
+    }
+
+    std::sort(times.begin(), times.end());
+    return { times.front(), times[times.size() / 2], times.back() };
+}
+
+inline void Print(const std::string &name, const Result &result) {
+    std::cout << std::left << std::setw(48) << name << std::right << std::fixed << std::setprecision(3)
+              << " min " << std::setw(10) << result.min << " ms"
+              << "  median " << std::setw(10) << result.median << " ms"
+              << "  max " << std::setw(10) << result.max << " ms" << std::endl;
+}
+
+/**
+ * @brief Keeps the compiler from optimizing away a result that is not used otherwise.
+ */
+template<typename T>
+inline void DoNotOptimize(const T &value) {
+    asm volatile("" : : "g"(&value) : "memory");
+}
+
+}  // namespace bgl::benchmark
+
+#endif  // BENCHMARKS_BENCHMARK_HPP_
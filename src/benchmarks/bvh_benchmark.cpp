@@ -0,0 +1,56 @@
+/**
+ * @file bvh_benchmark.cpp
+ * @brief Measures the construction of a Bvh and a TriangleBvh over a mesh of one million triangles.
+ */
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "height_field.hpp"
+#include "../gfx/bvh.hpp"
+#include "../gfx/thread_pool.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr std::uint32_t grid_width { 1000 };  // quads
+constexpr std::uint32_t grid_height { 500 };  // 2 * 1000 * 500 triangles
+constexpr int runs { 5 };
+
+std::vector<BvhPrimitive> get_primitives(const benchmark::HeightField &field) {
+    std::vector<BvhPrimitive> primitives;
+    primitives.reserve(field.triangles.size());
+    for (const TriangleBvh::Triangle &triangle : field.triangles) {
+        const vec3 &a { field.positions[triangle[0]] };
+        const vec3 &b { field.positions[triangle[1]] };
+        const vec3 &c { field.positions[triangle[2]] };
+        primitives.push_back({ glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) });
+    }
+    return primitives;
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    const bgl::benchmark::HeightField field { bgl::benchmark::CreateHeightField(bgl::grid_width, bgl::grid_height) };
+    const std::vector<bgl::BvhPrimitive> primitives { bgl::get_primitives(field) };
+    std::cout << field.triangles.size() << " triangles, " << bgl::ThreadPool::instance().size() << " threads, "
+              << bgl::runs << " runs" << std::endl;
+
+    bgl::benchmark::Print("Bvh of the triangle bounds", bgl::benchmark::Measure(bgl::runs, [&primitives] () {
+        bgl::benchmark::DoNotOptimize(bgl::Bvh { primitives });
+    }));
+    bgl::benchmark::Print("TriangleBvh, including the four-wide nodes", bgl::benchmark::Measure(bgl::runs, [&field] () {
+        bgl::benchmark::DoNotOptimize(bgl::TriangleBvh { field.positions, field.triangles, { 0 } });
+    }));
+
+    const bgl::Bvh bvh { primitives };
+    std::cout << bvh.getNodes().size() << " nodes" << std::endl;
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,52 @@
+/**
+ * @file height_field.hpp
+ * @brief A generated triangle mesh for the BVH benchmarks.
+ */
+#ifndef BENCHMARKS_HEIGHT_FIELD_HPP_
+#define BENCHMARKS_HEIGHT_FIELD_HPP_
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "../gfx/bvh.hpp"
+
+
+namespace bgl::benchmark {
+
+/**
+ * @brief A height field with some noise, like a scanned terrain, in [0, width] x [0, height] on the XZ plane.
+ */
+struct HeightField {
+    std::vector<vec3> positions;
+    std::vector<TriangleBvh::Triangle> triangles;  // two per quad
+};
+
+inline HeightField CreateHeightField(std::uint32_t width, std::uint32_t height) {
+    std::mt19937 generator { 5 };
+    std::uniform_real_distribution<float> noise { -0.1f, 0.1f };
+
+    HeightField field;
+    field.positions.reserve((width + 1) * (height + 1));
+    for (std::uint32_t y = 0; y <= height; ++y) {
+        for (std::uint32_t x = 0; x <= width; ++x) {
+            const float elevation { std::sin(x * 0.05f) * std::cos(y * 0.05f) * 10.0f + noise(generator) };
+            field.positions.push_back({ static_cast<float>(x), elevation, static_cast<float>(y) });
+        }
+    }
+
+    field.triangles.reserve(2 * width * height);
+    for (std::uint32_t y = 0; y < height; ++y) {
+        for (std::uint32_t x = 0; x < width; ++x) {
+            const std::uint32_t corner { y * (width + 1) + x };
+            field.triangles.push_back({ corner, corner + 1, corner + width + 1 });
+            field.triangles.push_back({ corner + 1, corner + width + 2, corner + width + 1 });
+        }
+    }
+    return field;
+}
+
+}  // namespace bgl::benchmark
+
+#endif  // BENCHMARKS_HEIGHT_FIELD_HPP_
@@ -0,0 +1,116 @@
+/**
+ * @file mipmap_benchmark.cpp
+ * @brief Compares the mip chain generation on the CPU against glGenerateMipmap().
+ * @details Needs an OpenGL 4.2 context, it is created on an offscreen surface.
+ */
+#include "../gfx/gl.hpp"
+
+#include <QGuiApplication>
+#include <QImage>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "../gfx/mipmap.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr int image_size { 2048 };
+constexpr int runs { 10 };
+
+QImage create_noise_image() {
+    QImage image { image_size, image_size, QImage::Format_RGBA8888 };
+    std::mt19937 random { 42 };
+    for (int y = 0; y < image.height(); ++y) {
+        auto * const row { reinterpret_cast<std::uint32_t*>(image.scanLine(y)) };
+        for (int x = 0; x < image.width(); ++x) {
+            row[x] = static_cast<std::uint32_t>(random());
+        }
+    }
+    return image;
+}
+
+GLsizei get_num_levels() noexcept {
+    return static_cast<GLsizei>(std::log2(image_size)) + 1;
+}
+
+GLuint create_texture() {
+    GLuint texture { 0 };
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexStorage2D(GL_TEXTURE_2D, get_num_levels(), GL_RGBA8, image_size, image_size);
+    return texture;
+}
+
+void benchmark_cpu(const QImage &image) {
+    for (const auto &[filter, name] : { std::pair { MipFilter::Box, "box" }, std::pair { MipFilter::Kaiser, "kaiser" } }) {
+        benchmark::Print(std::string { "GenerateMipChain() " } + name, benchmark::Measure(runs, [&image, filter = filter] () {
+            benchmark::DoNotOptimize(GenerateMipChain(image, filter));
+        }));
+    }
+
+    // the uploads that replace glGenerateMipmap() when the chain comes from the CPU
+    const std::vector<MipLevel> levels { GenerateMipChain(image, MipFilter::Box) };
+    const GLuint texture { create_texture() };
+    benchmark::Print("glTexSubImage2D() of all levels", benchmark::Measure(runs, [&levels] () {
+        for (auto level = 0u; level < levels.size(); ++level) {
+            glTexSubImage2D(GL_TEXTURE_2D, static_cast<GLint>(level), 0, 0,
+                            static_cast<GLsizei>(levels[level].width), static_cast<GLsizei>(levels[level].height),
+                            GL_RGBA, GL_UNSIGNED_BYTE, levels[level].texels.data());
+        }
+        glFinish();
+    }));
+    glDeleteTextures(1, &texture);
+}
+
+void benchmark_gpu(const QImage &image) {
+    const GLuint texture { create_texture() };
+    benchmark::Print("glTexSubImage2D() of level 0", benchmark::Measure(runs, [&image] () {
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, image_size, image_size, GL_RGBA, GL_UNSIGNED_BYTE, image.constBits());
+        glFinish();
+    }));
+    benchmark::Print("glGenerateMipmap()", benchmark::Measure(runs, [] () {
+        glGenerateMipmap(GL_TEXTURE_2D);
+        glFinish();
+    }));
+    glDeleteTextures(1, &texture);
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main(int argc, char *argv[]) {
+    QGuiApplication app(argc, argv);
+
+    QSurfaceFormat format;
+    format.setVersion(4, 2);
+    QOpenGLContext context;
+    context.setFormat(format);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    if (!context.create() || !context.makeCurrent(&surface) || glewInit() != GLEW_OK) {
+        std::cout << "could not create an OpenGL context" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << std::endl;
+    std::cout << bgl::image_size << "x" << bgl::image_size << " RGBA8, " << bgl::runs << " runs" << std::endl;
+
+    const QImage image { bgl::create_noise_image() };
+    bgl::benchmark_cpu(image);
+    bgl::benchmark_gpu(image);
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,112 @@
+/**
+ * @file picking_benchmark.cpp
+ * @brief Measures picks with TriangleBvh::intersect() on a mesh of ten million triangles.
+ * @details The first rays are checked against testing every triangle.
+ */
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "benchmark.hpp"
+#include "height_field.hpp"
+#include "../gfx/bvh.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr std::uint32_t grid_width { 2500 };   // quads
+constexpr std::uint32_t grid_height { 2000 };  // 2 * 2500 * 2000 triangles
+constexpr std::size_t picks { 1000 };          // per run
+constexpr int runs { 10 };
+constexpr std::size_t num_checked { 8 };       // rays compared with testing every triangle
+
+/**
+ * @brief Rays from a camera above the terrain towards random points on it, like clicks into the viewport.
+ */
+std::vector<Ray> create_rays() {
+    std::mt19937 generator { 9 };
+    std::uniform_real_distribution<float> x { 0.0f, static_cast<float>(grid_width) };
+    std::uniform_real_distribution<float> z { 0.0f, static_cast<float>(grid_height) };
+
+    const vec3 eye { grid_width * 0.5f, 500.0f, -200.0f };
+    std::vector<Ray> rays;
+    for (std::size_t i = 0; i < picks; ++i) {
+        const vec3 target { x(generator), 0.0f, z(generator) };
+        rays.push_back({ eye, glm::normalize(target - eye) });
+    }
+    return rays;
+}
+
+/**
+ * @brief Möller-Trumbore against every triangle, returns the distance to the closest hit.
+ */
+std::optional<float> intersect_all(const benchmark::HeightField &field, const Ray &ray) {
+    std::optional<float> closest;
+    for (const TriangleBvh::Triangle &triangle : field.triangles) {
+        const vec3 &a { field.positions[triangle[0]] };
+        const vec3 edge1 { field.positions[triangle[1]] - a };
+        const vec3 edge2 { field.positions[triangle[2]] - a };
+        const vec3 p { glm::cross(ray.direction, edge2) };
+        const float determinant { glm::dot(edge1, p) };
+        if (std::abs(determinant) < 1e-20f) {
+            continue;
+        }
+
+        const vec3 to_origin { ray.origin - a };
+        const vec3 q { glm::cross(to_origin, edge1) };
+        const float u { glm::dot(to_origin, p) / determinant };
+        const float v { glm::dot(ray.direction, q) / determinant };
+        const float distance { glm::dot(edge2, q) / determinant };
+        if (u >= 0.0f && v >= 0.0f && u + v <= 1.0f && distance > 0.0f && (!closest || distance < *closest)) {
+            closest = distance;
+        }
+    }
+    return closest;
+}
+
+bool check_hits(const benchmark::HeightField &field, const TriangleBvh &bvh, const std::vector<Ray> &rays) {
+    for (std::size_t i = 0; i < num_checked; ++i) {
+        const std::optional<RayHit> hit { bvh.intersect(rays[i]) };
+        const std::optional<float> expected { intersect_all(field, rays[i]) };
+        if (hit.has_value() != expected.has_value() ||
+            (hit && std::abs(hit->distance - *expected) > 1e-3f * *expected)) {
+            std::cout << "error: pick " << i << " differs from testing every triangle" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    const bgl::benchmark::HeightField field { bgl::benchmark::CreateHeightField(bgl::grid_width, bgl::grid_height) };
+    std::cout << field.triangles.size() << " triangles, " << bgl::picks << " picks per run, "
+              << bgl::runs << " runs" << std::endl;
+
+    const bgl::TriangleBvh bvh { field.positions, field.triangles, { 0 } };
+    const std::vector<bgl::Ray> rays { bgl::create_rays() };
+    if (!bgl::check_hits(field, bvh, rays)) {
+        return EXIT_FAILURE;
+    }
+
+    std::size_t hits { 0 };
+    const bgl::benchmark::Result result { bgl::benchmark::Measure(bgl::runs, [&] () {
+        hits = 0;
+        for (const bgl::Ray &ray : rays) {
+            hits += bvh.intersect(ray).has_value();
+        }
+    }) };
+    bgl::benchmark::Print("TriangleBvh::intersect()", result);
+    std::cout << "  " << result.median * 1000.0 / bgl::picks << " us per pick (median), "
+              << hits << " of " << bgl::picks << " rays hit" << std::endl;
+    return EXIT_SUCCESS;
+}
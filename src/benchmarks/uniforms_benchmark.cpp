@@ -0,0 +1,165 @@
+/**
+ * @file uniforms_benchmark.cpp
+ * @brief Compares the per-draw CPU cost of uniform updates by name against locations from a UniformTable.
+ * @details Needs an OpenGL 4.2 context, it is created on an offscreen surface.
+ */
+#include "../gfx/gl.hpp"
+
+#include <QGuiApplication>
+#include <QMatrix4x4>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QVector2D>
+#include <QVector3D>
+
+#include <cstdlib>
+#include <iostream>
+
+#include "benchmark.hpp"
+#include "../gfx/uniforms.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr int draws { 10000 };  // per run
+constexpr int runs { 20 };
+
+// the uniforms that Model updates per draw
+constexpr const char *vertex_shader { R"(
+#version 420 core
+uniform mat4 MVP;
+
+uniform struct VertexFormat {
+    vec3 offset;
+    vec3 scale;
+    bool octahedral;
+    vec2 texcoordOffset;
+    vec2 texcoordScale;
+} vertexFormat;
+
+out vec2 pixelTexCoord;
+
+void main() {
+    vec3 position = vertexFormat.offset + vertexFormat.scale * vec3(vertexFormat.octahedral ? 1.0 : 0.0);
+    gl_Position = MVP * vec4(position, 1.0);
+    pixelTexCoord = vertexFormat.texcoordOffset + vertexFormat.texcoordScale;
+}
+)" };
+
+constexpr const char *fragment_shader { R"(
+#version 420 core
+uniform sampler2D tex;
+
+in vec2 pixelTexCoord;
+out vec4 color;
+
+void main() {
+    color = texture(tex, pixelTexCoord);
+}
+)" };
+
+struct locations {
+    GLint MVP;
+    GLint offset;
+    GLint scale;
+    GLint octahedral;
+    GLint texcoordOffset;
+    GLint texcoordScale;
+    GLint texture;
+};
+
+void draw() {
+    glDrawArrays(GL_POINTS, 0, 1);
+}
+
+benchmark::Result benchmark_names(QOpenGLShaderProgram &program, const QMatrix4x4 &MVP) {
+    return benchmark::Measure(runs, [&program, &MVP] () {
+        for (int i = 0; i < draws; ++i) {
+            program.setUniformValue("MVP", MVP);
+            program.setUniformValue("vertexFormat.offset", QVector3D { 0.0f, 0.0f, 0.0f });
+            program.setUniformValue("vertexFormat.scale", QVector3D { 1.0f, 1.0f, 1.0f });
+            program.setUniformValue("vertexFormat.octahedral", GLuint { 1 });
+            program.setUniformValue("vertexFormat.texcoordOffset", QVector2D { 0.0f, 0.0f });
+            program.setUniformValue("vertexFormat.texcoordScale", QVector2D { 1.0f, 1.0f });
+            program.setUniformValue("tex", GLuint { 0 });
+            draw();
+        }
+        glFinish();
+    });
+}
+
+benchmark::Result benchmark_locations(QOpenGLShaderProgram &program, const QMatrix4x4 &MVP) {
+    const UniformTable table { program };
+    const locations uniforms {
+        .MVP = table.getLocation("MVP"),
+        .offset = table.getLocation("vertexFormat.offset"),
+        .scale = table.getLocation("vertexFormat.scale"),
+        .octahedral = table.getLocation("vertexFormat.octahedral"),
+        .texcoordOffset = table.getLocation("vertexFormat.texcoordOffset"),
+        .texcoordScale = table.getLocation("vertexFormat.texcoordScale"),
+        .texture = table.getLocation("tex") };
+
+    return benchmark::Measure(runs, [&program, &MVP, &uniforms] () {
+        for (int i = 0; i < draws; ++i) {
+            program.setUniformValue(uniforms.MVP, MVP);
+            program.setUniformValue(uniforms.offset, QVector3D { 0.0f, 0.0f, 0.0f });
+            program.setUniformValue(uniforms.scale, QVector3D { 1.0f, 1.0f, 1.0f });
+            program.setUniformValue(uniforms.octahedral, GLuint { 1 });
+            program.setUniformValue(uniforms.texcoordOffset, QVector2D { 0.0f, 0.0f });
+            program.setUniformValue(uniforms.texcoordScale, QVector2D { 1.0f, 1.0f });
+            program.setUniformValue(uniforms.texture, GLuint { 0 });
+            draw();
+        }
+        glFinish();
+    });
+}
+
+void print_per_draw(const char *name, const benchmark::Result &result) {
+    benchmark::Print(name, result);
+    std::cout << "  " << result.median * 1000.0 / draws << " us per draw (median)" << std::endl;
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main(int argc, char *argv[]) {
+    QGuiApplication app(argc, argv);
+
+    QSurfaceFormat format;
+    format.setVersion(4, 2);
+    QOpenGLContext context;
+    context.setFormat(format);
+    QOffscreenSurface surface;
+    surface.setFormat(format);
+    surface.create();
+    if (!context.create() || !context.makeCurrent(&surface) || glewInit() != GLEW_OK) {
+        std::cout << "could not create an OpenGL context" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << "OpenGL " << glGetString(GL_VERSION) << ", " << glGetString(GL_RENDERER) << std::endl;
+    std::cout << bgl::draws << " draws with 7 uniform updates each, " << bgl::runs << " runs" << std::endl;
+
+    QOpenGLShaderProgram program;
+    if (!program.addShaderFromSourceCode(QOpenGLShader::Vertex, bgl::vertex_shader) ||
+        !program.addShaderFromSourceCode(QOpenGLShader::Fragment, bgl::fragment_shader) || !program.link()) {
+        std::cout << "could not link the program: " << program.log().toStdString() << std::endl;
+        return EXIT_FAILURE;
+    }
+    program.bind();
+
+    GLuint vao { 0 };
+    glGenVertexArrays(1, &vao);
+    glBindVertexArray(vao);
+
+    QMatrix4x4 MVP;
+    MVP.perspective(60.0f, 1.0f, 0.1f, 100.0f);
+    bgl::print_per_draw("setUniformValue() by name", bgl::benchmark_names(program, MVP));
+    bgl::print_per_draw("setUniformValue() by UniformTable location", bgl::benchmark_locations(program, MVP));
+
+    glDeleteVertexArrays(1, &vao);
+    return EXIT_SUCCESS;
+}
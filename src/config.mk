@@ -0,0 +1,7 @@
+# Build configuration shared by all Makefiles, so the libraries, the demo,
+# the tests and the benchmarks are always built with the same definitions.
+
+# make GL_CHECKS=1 validates OpenGL calls with glGetError() and throws on errors
+ifeq ($(GL_CHECKS),1)
+DEFINES += -DBGL_CHECK_GL_ERRORS
+endif
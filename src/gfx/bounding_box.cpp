@@ -1,3 +1,5 @@
+#include <limits>
+
 #include "bounding_box.hpp"
 
 
@@ -15,9 +17,42 @@ vec3 BoundingBox::getSize() const noexcept {
     return _size;
 }
 
+vec3 BoundingBox::getCenter() const noexcept {
+    return _center;
+}
+
+vec3 BoundingBox::getMin() const noexcept {
+    return _center - _size / 2.0f;
+}
+
+vec3 BoundingBox::getMax() const noexcept {
+    return _center + _size / 2.0f;
+}
+
 void BoundingBox::resize(const vec3 &size) {
     _size = size;
 }
 
-}  // namespace bgl
+bool BoundingBox::collides(const BoundingBox &other) const noexcept {
+    const vec3 distance { glm::abs(_center - other._center) };
+    const vec3 extents { (_size + other._size) / 2.0f };
+    return distance.x <= extents.x && distance.y <= extents.y && distance.z <= extents.z;
+}
 
+BoundingBox TransformBoundingBox(const BoundingBox &box, const mat4 &transform) noexcept {
+    const vec3 box_min { box.getMin() };
+    const vec3 box_max { box.getMax() };
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (int corner = 0; corner < 8; ++corner) {
+        const vec3 point { (corner & 1) ? box_max.x : box_min.x,
+                           (corner & 2) ? box_max.y : box_min.y,
+                           (corner & 4) ? box_max.z : box_min.z };
+        const vec3 transformed { transform * vec4 { point, 1.0f } };
+        min = glm::min(min, transformed);
+        max = glm::max(max, transformed);
+    }
+    return BoundingBox { (min + max) / 2.0f, max - min };
+}
+
+}  // namespace bgl
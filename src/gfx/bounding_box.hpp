@@ -12,17 +12,28 @@ class BoundingBox {
 	BoundingBox(const vec3 &center, const vec3 &size);
 
 	vec3 getSize() const noexcept;
+	vec3 getCenter() const noexcept;
+	vec3 getMin() const noexcept;
+	vec3 getMax() const noexcept;
 	void resize(const vec3 &size);
-	// TODO: getCenter()
 	// TODO: setCenter()
 	// TODO: translate()
-	// TODO: collides()
+
+	/**
+	 * @brief Returns whether the box overlaps @p other, touching counts as overlapping.
+	 */
+	bool collides(const BoundingBox &other) const noexcept;
 
  private:
 	vec3 _center;
 	vec3 _size;
 };
 
+/**
+ * @brief Returns the axis aligned box enclosing @p box after it was transformed by @p transform.
+ */
+BoundingBox TransformBoundingBox(const BoundingBox &box, const mat4 &transform) noexcept;
+
 }  // namespace bgl
 
 #endif  // GFX_BOUNDING_BOX_HPP
@@ -1,5 +1,6 @@
 #include "box.hpp"
 #include "gfx.hpp"
+#include "uniforms.hpp"
 
 #include <algorithm>
 #include <iostream>
@@ -71,6 +72,10 @@ Box::Box() {
     _program->bind();
     set_va_attribute(_program->attributeLocation("position"), 3, GL_FLOAT, 0, 0);
     _program->release();
+
+    const UniformTable uniforms { *_program };
+    _locations.MVP = uniforms.getLocation("MVP");
+    _locations.color = uniforms.getLocation("color");
 }
 
 Box::Box(const BoundingBox &boundingBox)
@@ -83,12 +88,12 @@ void Box::render(const mat4 &VP) {
     _program->bind();
     glLineWidth(3);
 
-    mat4 M = glm::scale(_boundingBox.getSize());
+    mat4 M = glm::translate(_boundingBox.getCenter()) * glm::scale(_boundingBox.getSize());
     QMatrix4x4 matrix(glm::value_ptr(VP * M));
-    _program->setUniformValue("MVP", matrix.transposed());
+    _program->setUniformValue(_locations.MVP, matrix.transposed());
 
     const vec3 color { 1.0, 0.0, 0.0 }; /* red */
-    _program->setUniformValue("color", color.x, color.y, color.z);
+    _program->setUniformValue(_locations.color, color.x, color.y, color.z);
 
     _meshes[0].render(GL_LINES);
 }
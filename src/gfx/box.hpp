@@ -17,6 +17,12 @@ class Box final : public Model {
 	// TODO
 
 	void render(const mat4 &VP) override;
+
+ private:
+	struct {
+		GLint MVP { -1 };
+		GLint color { -1 };
+	} _locations;
 };
 
 }  // namespace bgl
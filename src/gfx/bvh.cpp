@@ -0,0 +1,717 @@
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <optional>
+#include <stdexcept>
+#include <utility>  // std::move()
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif  // __SSE2__
+
+#include "bvh.hpp"
+#include "thread_pool.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr std::size_t num_bins { 16 };
+constexpr std::uint32_t max_leaf_size { 4 };      // lets a leaf of triangles be tested at once with SSE
+constexpr float traversal_cost { 1.0f };          // relative to the cost of testing a primitive
+constexpr std::size_t max_sah_depth { 32 };       // below it the nodes are split at the median
+constexpr std::size_t min_subtree_size { 4096 };  // primitives of a subtree built as one task
+constexpr std::size_t chunk_size { 4096 };        // primitives per ParallelFor() task
+
+struct bounds {
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+
+    void grow(const vec3 &point) noexcept {
+        min = glm::min(min, point);
+        max = glm::max(max, point);
+    }
+
+    void grow(const vec3 &other_min, const vec3 &other_max) noexcept {
+        min = glm::min(min, other_min);
+        max = glm::max(max, other_max);
+    }
+
+    /**
+     * @brief Returns half the surface area, the factor two cancels out in the SAH.
+     */
+    float area() const noexcept {
+        const vec3 size { glm::max(max - min, vec3 { 0.0f }) };
+        return size.x * size.y + size.y * size.z + size.z * size.x;
+    }
+};
+
+/**
+ * @brief Calls @p function with ranges of [0, @p count) on the ThreadPool.
+ */
+template<typename F>
+void parallel_chunks(std::size_t count, F &&function) {
+    ParallelFor((count + chunk_size - 1) / chunk_size, [&] (std::size_t chunk) {
+        function(chunk * chunk_size, std::min(count, (chunk + 1) * chunk_size));
+    });
+}
+
+struct split {
+    int axis;
+    std::size_t bin;  // the first bin of the right child
+    float cost;       // of the traversal and the children, relative to testing a primitive
+};
+
+/**
+ * @brief A subtree whose construction is deferred to the ThreadPool.
+ */
+struct subtree {
+    std::uint32_t node;  // placeholder in the top levels
+    std::uint32_t begin;
+    std::uint32_t end;
+    std::size_t depth;   // of the placeholder
+    std::vector<BvhNode> nodes;
+};
+
+/**
+ * @brief Builds the nodes over a range of primitive indices.
+ */
+class builder final {
+ public:
+    builder(const std::vector<BvhPrimitive> &primitives, std::vector<std::uint32_t> &indices, BvhLeaves leaves)
+        : _primitives { primitives },
+          _indices { indices },
+          _leaves { leaves },
+          _centroids(primitives.size()) {
+        parallel_chunks(primitives.size(), [&] (std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                _centroids[i] = (primitives[i].min + primitives[i].max) * 0.5f;
+            }
+        });
+    }
+
+    /**
+     * @brief Builds the subtree of @p node over [@p begin, @p end).
+     * @param deferred Receives the subtrees that are small enough to be built by one task, if set.
+     */
+    void build(std::vector<BvhNode> &nodes, std::uint32_t node, std::uint32_t begin, std::uint32_t end,
+               std::size_t depth, std::vector<subtree> *deferred) const {
+        bounds box, centroids;
+        for (std::uint32_t i = begin; i < end; ++i) {
+            const BvhPrimitive &primitive { _primitives[_indices[i]] };
+            box.grow(primitive.min, primitive.max);
+            centroids.grow(_centroids[_indices[i]]);
+        }
+
+        const std::uint32_t count { end - begin };
+        nodes[node] = { box.min, begin, box.max, count };
+        if (deferred != nullptr && count <= _subtreeSize) {
+            deferred->push_back({ node, begin, end, depth, {} });
+            return;
+        }
+
+        if (count <= max_leaf_size && _leaves == BvhLeaves::Packed) {
+            return;  // testing up to four primitives at once costs as much as testing one
+        }
+        if (depth >= Bvh::maxDepth) {
+            return;  // bounds the traversal stacks, median splits never get here with 32-bit indices
+        }
+
+        const std::optional<split> best { depth < max_sah_depth ? find_split(begin, end, box, centroids)
+                                                                : std::nullopt };
+        if (count <= max_leaf_size && (!best || best->cost >= static_cast<float>(count))) {
+            return;  // cheaper as a leaf
+        }
+
+        std::uint32_t middle { begin + count / 2 };
+        if (best) {
+            const float scale { num_bins / (centroids.max[best->axis] - centroids.min[best->axis]) };
+            const auto it { std::partition(_indices.begin() + begin, _indices.begin() + end,
+                                           [&] (std::uint32_t index) {
+                return get_bin(_centroids[index][best->axis], centroids.min[best->axis], scale) < best->bin;
+            }) };
+            middle = static_cast<std::uint32_t>(it - _indices.begin());
+        } else {
+            const int axis { get_longest_axis(centroids) };
+            std::nth_element(_indices.begin() + begin, _indices.begin() + middle, _indices.begin() + end,
+                             [&] (std::uint32_t a, std::uint32_t b) {
+                return _centroids[a][axis] < _centroids[b][axis];
+            });
+        }
+
+        const auto first { static_cast<std::uint32_t>(nodes.size()) };
+        nodes.resize(nodes.size() + 2);
+        nodes[node].first = first;
+        nodes[node].count = 0;
+        build(nodes, first, begin, middle, depth + 1, deferred);
+        build(nodes, first + 1, middle, end, depth + 1, deferred);
+    }
+
+    void setSubtreeSize(std::size_t size) noexcept {
+        _subtreeSize = size;
+    }
+
+ private:
+    static std::size_t get_bin(float centroid, float min, float scale) noexcept {
+        return std::min(num_bins - 1, static_cast<std::size_t>((centroid - min) * scale));
+    }
+
+    static int get_longest_axis(const bounds &box) noexcept {
+        const vec3 size { box.max - box.min };
+        return size.x >= size.y && size.x >= size.z ? 0 : (size.y >= size.z ? 1 : 2);
+    }
+
+    /**
+     * @brief Returns the cheapest split between the bins of all three axes.
+     * @return Nothing if all centroids coincide.
+     */
+    std::optional<split> find_split(std::uint32_t begin, std::uint32_t end,
+                                    const bounds &box, const bounds &centroids) const {
+        std::optional<split> best;
+        for (int axis = 0; axis < 3; ++axis) {
+            const float extent { centroids.max[axis] - centroids.min[axis] };
+            if (extent <= 0.0f) {
+                continue;
+            }
+
+            std::array<bounds, num_bins> bins;
+            std::array<std::uint32_t, num_bins> counts {};
+            const float scale { num_bins / extent };
+            for (std::uint32_t i = begin; i < end; ++i) {
+                const std::uint32_t index { _indices[i] };
+                const std::size_t bin { get_bin(_centroids[index][axis], centroids.min[axis], scale) };
+                bins[bin].grow(_primitives[index].min, _primitives[index].max);
+                ++counts[bin];
+            }
+
+            // sweeps from the right, then evaluates each split while sweeping from the left
+            std::array<float, num_bins> right_costs {};
+            std::array<std::uint32_t, num_bins> right_counts {};
+            bounds right;
+            std::uint32_t right_count { 0 };
+            for (std::size_t bin = num_bins - 1; bin > 0; --bin) {
+                right.grow(bins[bin].min, bins[bin].max);
+                right_count += counts[bin];
+                right_costs[bin] = right.area() * static_cast<float>(right_count);
+                right_counts[bin] = right_count;
+            }
+
+            bounds left;
+            std::uint32_t left_count { 0 };
+            for (std::size_t bin = 1; bin < num_bins; ++bin) {
+                left.grow(bins[bin - 1].min, bins[bin - 1].max);
+                left_count += counts[bin - 1];
+                if (left_count == 0 || right_counts[bin] == 0) {
+                    continue;
+                }
+
+                const float cost { left.area() * static_cast<float>(left_count) + right_costs[bin] };
+                if (!best || cost < best->cost) {
+                    best = split { axis, bin, cost };
+                }
+            }
+        }
+
+        if (best) {
+            const float area { box.area() };
+            best->cost = traversal_cost + (area > 0.0f ? best->cost / area : 0.0f);
+        }
+        return best;
+    }
+
+    const std::vector<BvhPrimitive> &_primitives;
+    std::vector<std::uint32_t> &_indices;
+    BvhLeaves _leaves;
+    std::vector<vec3> _centroids;
+    std::size_t _subtreeSize { 0 };
+};
+
+bool overlaps(const BvhPrimitive &a, const vec3 &min, const vec3 &max) noexcept {
+    return a.min.x <= max.x && a.max.x >= min.x &&
+           a.min.y <= max.y && a.max.y >= min.y &&
+           a.min.z <= max.z && a.max.z >= min.z;
+}
+
+std::vector<BvhPrimitive> get_primitives(const std::vector<BoundingBox> &boxes) {
+    std::vector<BvhPrimitive> primitives;
+    primitives.reserve(boxes.size());
+    for (const BoundingBox &box : boxes) {
+        primitives.push_back({ box.getMin(), box.getMax() });
+    }
+    return primitives;
+}
+
+/*********************************************************
+ *                    Ray Intersection                   *
+ *********************************************************/
+constexpr float min_direction { 1e-20f };  // keeps the slab test free of 0 * infinity
+constexpr float min_determinant { 1e-20f };
+
+struct ray_data {
+    vec3 origin;
+    vec3 direction;
+    vec3 inverse_direction;
+};
+
+ray_data get_ray_data(const Ray &ray) noexcept {
+    vec3 direction { ray.direction };
+    for (int axis = 0; axis < 3; ++axis) {
+        if (std::abs(direction[axis]) < min_direction) {
+            direction[axis] = std::copysign(min_direction, direction[axis]);
+        }
+    }
+    return { ray.origin, ray.direction, 1.0f / direction };
+}
+
+/**
+ * @brief The vertices of up to four triangles in a structure of arrays layout.
+ */
+struct alignas(16) triangle_packet {
+    std::array<float, 4> ax, ay, az;
+    std::array<float, 4> bx, by, bz;
+    std::array<float, 4> cx, cy, cz;
+
+    void set(std::size_t lane, const vec3 &a, const vec3 &b, const vec3 &c) noexcept {
+        ax[lane] = a.x; ay[lane] = a.y; az[lane] = a.z;
+        bx[lane] = b.x; by[lane] = b.y; bz[lane] = b.z;
+        cx[lane] = c.x; cy[lane] = c.y; cz[lane] = c.z;
+    }
+};
+
+#if !defined(__SSE2__)
+/**
+ * @brief Möller-Trumbore, returns the distance along the ray if the triangle is hit.
+ */
+std::optional<float> intersect_triangle(const vec3 &a, const vec3 &b, const vec3 &c,
+                                        const ray_data &ray) noexcept {
+    const vec3 edge1 { b - a };
+    const vec3 edge2 { c - a };
+    const vec3 p { glm::cross(ray.direction, edge2) };
+    const float determinant { glm::dot(edge1, p) };
+    if (std::abs(determinant) < min_determinant) {
+        return {};  // parallel to the triangle
+    }
+
+    const float inverse_determinant { 1.0f / determinant };
+    const vec3 to_origin { ray.origin - a };
+    const float u { glm::dot(to_origin, p) * inverse_determinant };
+    const vec3 q { glm::cross(to_origin, edge1) };
+    const float v { glm::dot(ray.direction, q) * inverse_determinant };
+    const float distance { glm::dot(edge2, q) * inverse_determinant };
+    if (u < 0.0f || v < 0.0f || u + v > 1.0f || distance <= 0.0f) {
+        return {};
+    }
+    return distance;
+}
+#endif  // __SSE2__
+
+/**
+ * @brief Tests the ray against the boxes of a node.
+ * @param[out] distances At which the ray enters each box.
+ * @return A bit per box the ray enters before @p max_distance.
+ */
+unsigned intersect_boxes(const WideBvhNode &node, const ray_data &ray, float max_distance,
+                         std::array<float, 4> &distances) noexcept {
+    const unsigned used { (1u << node.size) - 1 };
+#if defined(__SSE2__)
+    const auto slab = [] (const std::array<float, 4> &min, const std::array<float, 4> &max,
+                          float origin, float inverse_direction, __m128 &near, __m128 &far) {
+        const __m128 o { _mm_set1_ps(origin) };
+        const __m128 d { _mm_set1_ps(inverse_direction) };
+        const __m128 t0 { _mm_mul_ps(_mm_sub_ps(_mm_load_ps(min.data()), o), d) };
+        const __m128 t1 { _mm_mul_ps(_mm_sub_ps(_mm_load_ps(max.data()), o), d) };
+        near = _mm_max_ps(near, _mm_min_ps(t0, t1));
+        far = _mm_min_ps(far, _mm_max_ps(t0, t1));
+    };
+
+    __m128 near { _mm_setzero_ps() };
+    __m128 far { _mm_set1_ps(max_distance) };
+    slab(node.minX, node.maxX, ray.origin.x, ray.inverse_direction.x, near, far);
+    slab(node.minY, node.maxY, ray.origin.y, ray.inverse_direction.y, near, far);
+    slab(node.minZ, node.maxZ, ray.origin.z, ray.inverse_direction.z, near, far);
+    _mm_storeu_ps(distances.data(), near);
+    return static_cast<unsigned>(_mm_movemask_ps(_mm_cmple_ps(near, far))) & used;
+#else
+    unsigned hits { 0 };
+    for (std::uint32_t i = 0; i < node.size; ++i) {
+        const vec3 t0 { (vec3 { node.minX[i], node.minY[i], node.minZ[i] } - ray.origin) * ray.inverse_direction };
+        const vec3 t1 { (vec3 { node.maxX[i], node.maxY[i], node.maxZ[i] } - ray.origin) * ray.inverse_direction };
+        const vec3 near { glm::min(t0, t1) };
+        const vec3 far { glm::max(t0, t1) };
+        distances[i] = std::max({ near.x, near.y, near.z, 0.0f });
+        if (distances[i] <= std::min({ far.x, far.y, far.z, max_distance })) {
+            hits |= 1u << i;
+        }
+    }
+    return hits & used;
+#endif  // __SSE2__
+}
+
+/**
+ * @brief Tests the ray against @p count triangles of a packet, front or back facing.
+ * @param[out] distances Along the ray to each hit triangle.
+ * @return A bit per triangle the ray hits before @p max_distance.
+ */
+unsigned intersect_triangles(const triangle_packet &packet, std::size_t count, const ray_data &ray,
+                             float max_distance, std::array<float, 4> &distances) noexcept {
+    const unsigned used { (1u << count) - 1 };
+#if defined(__SSE2__)
+    // Möller-Trumbore on four triangles at once
+    const auto load = [] (const std::array<float, 4> &values) { return _mm_load_ps(values.data()); };
+    const __m128 ax { load(packet.ax) }, ay { load(packet.ay) }, az { load(packet.az) };
+    const __m128 e1x { _mm_sub_ps(load(packet.bx), ax) };
+    const __m128 e1y { _mm_sub_ps(load(packet.by), ay) };
+    const __m128 e1z { _mm_sub_ps(load(packet.bz), az) };
+    const __m128 e2x { _mm_sub_ps(load(packet.cx), ax) };
+    const __m128 e2y { _mm_sub_ps(load(packet.cy), ay) };
+    const __m128 e2z { _mm_sub_ps(load(packet.cz), az) };
+    const __m128 dx { _mm_set1_ps(ray.direction.x) };
+    const __m128 dy { _mm_set1_ps(ray.direction.y) };
+    const __m128 dz { _mm_set1_ps(ray.direction.z) };
+
+    // p = d x e2
+    const __m128 px { _mm_sub_ps(_mm_mul_ps(dy, e2z), _mm_mul_ps(dz, e2y)) };
+    const __m128 py { _mm_sub_ps(_mm_mul_ps(dz, e2x), _mm_mul_ps(dx, e2z)) };
+    const __m128 pz { _mm_sub_ps(_mm_mul_ps(dx, e2y), _mm_mul_ps(dy, e2x)) };
+    const __m128 determinant { _mm_add_ps(_mm_add_ps(_mm_mul_ps(e1x, px), _mm_mul_ps(e1y, py)),
+                                          _mm_mul_ps(e1z, pz)) };
+    const __m128 inverse_determinant { _mm_div_ps(_mm_set1_ps(1.0f), determinant) };
+
+    // t = o - a, q = t x e1
+    const __m128 tx { _mm_sub_ps(_mm_set1_ps(ray.origin.x), ax) };
+    const __m128 ty { _mm_sub_ps(_mm_set1_ps(ray.origin.y), ay) };
+    const __m128 tz { _mm_sub_ps(_mm_set1_ps(ray.origin.z), az) };
+    const __m128 qx { _mm_sub_ps(_mm_mul_ps(ty, e1z), _mm_mul_ps(tz, e1y)) };
+    const __m128 qy { _mm_sub_ps(_mm_mul_ps(tz, e1x), _mm_mul_ps(tx, e1z)) };
+    const __m128 qz { _mm_sub_ps(_mm_mul_ps(tx, e1y), _mm_mul_ps(ty, e1x)) };
+
+    const auto dot = [] (__m128 x0, __m128 y0, __m128 z0, __m128 x1, __m128 y1, __m128 z1) {
+        return _mm_add_ps(_mm_add_ps(_mm_mul_ps(x0, x1), _mm_mul_ps(y0, y1)), _mm_mul_ps(z0, z1));
+    };
+    const __m128 u { _mm_mul_ps(dot(tx, ty, tz, px, py, pz), inverse_determinant) };
+    const __m128 v { _mm_mul_ps(dot(dx, dy, dz, qx, qy, qz), inverse_determinant) };
+    const __m128 distance { _mm_mul_ps(dot(e2x, e2y, e2z, qx, qy, qz), inverse_determinant) };
+
+    const __m128 zero { _mm_setzero_ps() };
+    const __m128 abs_determinant { _mm_andnot_ps(_mm_set1_ps(-0.0f), determinant) };
+    __m128 hit { _mm_cmpge_ps(abs_determinant, _mm_set1_ps(min_determinant)) };
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(u, zero));
+    hit = _mm_and_ps(hit, _mm_cmpge_ps(v, zero));
+    hit = _mm_and_ps(hit, _mm_cmple_ps(_mm_add_ps(u, v), _mm_set1_ps(1.0f)));
+    hit = _mm_and_ps(hit, _mm_cmpgt_ps(distance, zero));
+    hit = _mm_and_ps(hit, _mm_cmplt_ps(distance, _mm_set1_ps(max_distance)));
+    _mm_storeu_ps(distances.data(), distance);
+    return static_cast<unsigned>(_mm_movemask_ps(hit)) & used;
+#else
+    unsigned hits { 0 };
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::optional<float> distance {
+            intersect_triangle({ packet.ax[i], packet.ay[i], packet.az[i] },
+                               { packet.bx[i], packet.by[i], packet.bz[i] },
+                               { packet.cx[i], packet.cy[i], packet.cz[i] }, ray) };
+        if (distance && *distance < max_distance) {
+            distances[i] = *distance;
+            hits |= 1u << i;
+        }
+    }
+    return hits & used;
+#endif  // __SSE2__
+}
+
+float get_area(const BvhNode &node) noexcept {
+    const vec3 size { node.max - node.min };
+    return size.x * size.y + size.y * size.z + size.z * size.x;
+}
+
+}  // anonymous namespace
+
+/*********************************************************
+ *                          Bvh                          *
+ *********************************************************/
+Bvh::Bvh(const std::vector<BvhPrimitive> &primitives, BvhLeaves leaves) {
+    if (primitives.size() >= std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error { "too many primitives for a BVH" };
+    }
+    if (primitives.empty()) {
+        return;
+    }
+
+    const auto count { static_cast<std::uint32_t>(primitives.size()) };
+    _primitives.resize(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        _primitives[i] = i;
+    }
+
+    builder tree_builder { primitives, _primitives, leaves };
+    _nodes.reserve(2 * count);
+    _nodes.resize(1);
+
+    // a few subtrees per worker balance the differently sized ones
+    const std::size_t num_subtrees { 4 * ThreadPool::instance().size() };
+    if (count < 2 * min_subtree_size || num_subtrees < 2) {
+        tree_builder.build(_nodes, 0, 0, count, 0, nullptr);
+    } else {
+        std::vector<subtree> subtrees;
+        tree_builder.setSubtreeSize(std::max(min_subtree_size, count / num_subtrees));
+        tree_builder.build(_nodes, 0, 0, count, 0, &subtrees);
+
+        ParallelFor(subtrees.size(), [&] (std::size_t i) {
+            subtree &tree { subtrees[i] };
+            tree.nodes.resize(1);
+            tree_builder.build(tree.nodes, 0, tree.begin, tree.end, tree.depth, nullptr);
+        });
+
+        // moves the roots into their placeholders and appends the other nodes
+        for (subtree &tree : subtrees) {
+            const auto offset { static_cast<std::uint32_t>(_nodes.size() - 1) };
+            for (BvhNode &node : tree.nodes) {
+                if (!node.isLeaf()) {
+                    node.first += offset;
+                }
+            }
+            _nodes[tree.node] = tree.nodes.front();
+            _nodes.insert(_nodes.end(), tree.nodes.begin() + 1, tree.nodes.end());
+        }
+    }
+    _nodes.shrink_to_fit();
+
+    _bounds.resize(count);
+    parallel_chunks(count, [&] (std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            _bounds[i] = primitives[_primitives[i]];
+        }
+    });
+}
+
+Bvh::Bvh(const std::vector<BoundingBox> &boxes, BvhLeaves leaves)
+    : Bvh { get_primitives(boxes), leaves } {
+}
+
+bool Bvh::empty() const noexcept {
+    return _nodes.empty();
+}
+
+std::size_t Bvh::size() const noexcept {
+    return _primitives.size();
+}
+
+const std::vector<BvhNode>& Bvh::getNodes() const noexcept {
+    return _nodes;
+}
+
+const std::vector<std::uint32_t>& Bvh::getPrimitives() const noexcept {
+    return _primitives;
+}
+
+std::vector<std::uint32_t> Bvh::query(const BoundingBox &box) const {
+    const BvhPrimitive bounds { box.getMin(), box.getMax() };
+    std::vector<std::uint32_t> result;
+    traverseLeaves([&] (const vec3 &min, const vec3 &max) {
+        return overlaps(bounds, min, max);
+    }, [&] (const BvhNode &leaf) {
+        // the leaves may hold primitives outside the box
+        for (std::uint32_t i = leaf.first; i < leaf.first + leaf.count; ++i) {
+            if (overlaps(_bounds[i], bounds.min, bounds.max)) {
+                result.push_back(_primitives[i]);
+            }
+        }
+    });
+    return result;
+}
+
+std::vector<std::uint32_t> Bvh::query(const Frustum &frustum) const {
+    const auto intersects = [&frustum] (const vec3 &min, const vec3 &max) {
+        return frustum.intersects((min + max) * 0.5f, (max - min) * 0.5f);
+    };
+
+    std::vector<std::uint32_t> result;
+    traverseLeaves(intersects, [&] (const BvhNode &leaf) {
+        // the leaves may hold primitives outside the frustum
+        for (std::uint32_t i = leaf.first; i < leaf.first + leaf.count; ++i) {
+            if (intersects(_bounds[i].min, _bounds[i].max)) {
+                result.push_back(_primitives[i]);
+            }
+        }
+    });
+    return result;
+}
+
+/*********************************************************
+ *                      Triangle Bvh                     *
+ *********************************************************/
+TriangleBvh::TriangleBvh(std::vector<vec3> positions, std::vector<Triangle> triangles,
+                         std::vector<std::uint32_t> firstTriangles)
+    : _positions { std::move(positions) },
+      _triangles { std::move(triangles) },
+      _firstTriangles { std::move(firstTriangles) } {
+    std::vector<BvhPrimitive> primitives(_triangles.size());
+    parallel_chunks(_triangles.size(), [&] (std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const Triangle &triangle { _triangles[i] };
+            const vec3 &a { _positions[triangle[0]] };
+            const vec3 &b { _positions[triangle[1]] };
+            const vec3 &c { _positions[triangle[2]] };
+            primitives[i] = { glm::min(a, glm::min(b, c)), glm::max(a, glm::max(b, c)) };
+        }
+    });
+    _bvh = Bvh { primitives, BvhLeaves::Packed };
+
+    if (!_bvh.empty()) {
+        _wideNodes.reserve(_bvh.getNodes().size() / 3 + 1);
+        collapse(0);
+    }
+}
+
+/**
+ * @details Opens the inner child with the largest surface until there are four children.
+ */
+std::uint32_t TriangleBvh::collapse(std::uint32_t node) {
+    const std::vector<BvhNode> &nodes { _bvh.getNodes() };
+    std::array<std::uint32_t, 4> children;
+    std::uint32_t size { 0 };
+    if (nodes[node].isLeaf()) {
+        children[size++] = node;
+    } else {
+        children[size++] = nodes[node].first;
+        children[size++] = nodes[node].first + 1;
+    }
+
+    while (size < children.size()) {
+        std::optional<std::uint32_t> largest;
+        for (std::uint32_t i = 0; i < size; ++i) {
+            if (!nodes[children[i]].isLeaf() &&
+                (!largest || get_area(nodes[children[i]]) > get_area(nodes[children[*largest]]))) {
+                largest = i;
+            }
+        }
+        if (!largest) {
+            break;
+        }
+
+        const std::uint32_t first { nodes[children[*largest]].first };
+        children[*largest] = first;
+        children[size++] = first + 1;
+    }
+
+    const auto index { static_cast<std::uint32_t>(_wideNodes.size()) };
+    _wideNodes.emplace_back();
+    _wideNodes[index].size = size;
+    for (std::uint32_t i = 0; i < size; ++i) {
+        const BvhNode &child { nodes[children[i]] };
+        const std::uint32_t first { child.isLeaf() ? child.first : collapse(children[i]) };
+
+        WideBvhNode &wide { _wideNodes[index] };  // collapse() may have moved the nodes
+        wide.minX[i] = child.min.x;
+        wide.minY[i] = child.min.y;
+        wide.minZ[i] = child.min.z;
+        wide.maxX[i] = child.max.x;
+        wide.maxY[i] = child.max.y;
+        wide.maxZ[i] = child.max.z;
+        wide.first[i] = first;
+        wide.count[i] = child.count;
+    }
+    return index;
+}
+
+const std::vector<vec3>& TriangleBvh::getPositions() const noexcept {
+    return _positions;
+}
+
+const std::vector<TriangleBvh::Triangle>& TriangleBvh::getTriangles() const noexcept {
+    return _triangles;
+}
+
+const Bvh& TriangleBvh::getBvh() const noexcept {
+    return _bvh;
+}
+
+std::pair<std::size_t, std::size_t> TriangleBvh::locate(std::size_t triangle) const {
+    if (triangle >= _triangles.size() || _firstTriangles.empty()) {
+        throw std::out_of_range { "invalid triangle index" };
+    }
+
+    // the last mesh starting at or before the triangle
+    const auto it { std::upper_bound(_firstTriangles.begin(), _firstTriangles.end(), triangle) - 1 };
+    return { static_cast<std::size_t>(it - _firstTriangles.begin()), triangle - *it };
+}
+
+std::optional<RayHit> TriangleBvh::intersect(const Ray &ray) const {
+    if (_wideNodes.empty()) {
+        return {};
+    }
+
+    const ray_data data { get_ray_data(ray) };
+    const std::vector<std::uint32_t> &primitives { _bvh.getPrimitives() };
+    float closest { std::numeric_limits<float>::infinity() };
+    std::optional<std::size_t> closest_triangle;
+
+    struct entry {
+        std::uint32_t node;
+        float distance;  // at which the ray enters the node
+    };
+    std::array<entry, 3 * Bvh::maxDepth + 1> stack;  // up to three siblings wait on each level
+    std::size_t size { 0 };
+    stack[size++] = { 0, 0.0f };
+
+    while (size > 0) {
+        const entry current { stack[--size] };
+        if (current.distance >= closest) {
+            continue;  // a closer triangle was found since it was pushed
+        }
+
+        const WideBvhNode &node { _wideNodes[current.node] };
+        std::array<float, 4> distances;
+        const unsigned hits { intersect_boxes(node, data, closest, distances) };
+
+        std::array<entry, 4> children;
+        std::size_t num_children { 0 };
+        for (std::uint32_t i = 0; i < node.size; ++i) {
+            if ((hits & (1u << i)) == 0) {
+                continue;
+            }
+            if (node.count[i] == 0) {
+                children[num_children++] = { node.first[i], distances[i] };
+                continue;
+            }
+
+            for (std::uint32_t offset = 0; offset < node.count[i]; offset += 4) {
+                const std::size_t count { std::min<std::size_t>(4, node.count[i] - offset) };
+                triangle_packet packet;
+                for (std::size_t j = 0; j < 4; ++j) {
+                    // repeats the first triangle in the unused lanes
+                    const Triangle &triangle { _triangles[primitives[node.first[i] + offset + (j < count ? j : 0)]] };
+                    packet.set(j, _positions[triangle[0]], _positions[triangle[1]], _positions[triangle[2]]);
+                }
+
+                std::array<float, 4> triangle_distances;
+                const unsigned triangle_hits { intersect_triangles(packet, count, data, closest, triangle_distances) };
+                for (std::size_t j = 0; j < count; ++j) {
+                    if ((triangle_hits & (1u << j)) != 0 && triangle_distances[j] < closest) {
+                        closest = triangle_distances[j];
+                        closest_triangle = primitives[node.first[i] + offset + j];
+                    }
+                }
+            }
+        }
+
+        // the nearest child is visited first, an insertion sort of at most four children
+        for (std::size_t i = 1; i < num_children; ++i) {
+            for (std::size_t j = i; j > 0 && children[j - 1].distance < children[j].distance; --j) {
+                std::swap(children[j - 1], children[j]);
+            }
+        }
+        assert(size + num_children <= stack.size() && "deeper than Bvh::maxDepth");
+        for (std::size_t i = 0; i < num_children; ++i) {
+            stack[size++] = children[i];
+        }
+    }
+
+    if (!closest_triangle) {
+        return {};
+    }
+    return RayHit { *closest_triangle, closest, ray.origin + ray.direction * closest };
+}
+
+}  // namespace bgl
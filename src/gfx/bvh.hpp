@@ -0,0 +1,212 @@
+/**
+ * @file bvh.hpp
+ * @brief Bounding volume hierarchies for culling, picking and other spatial queries.
+ */
+#ifndef GFX_BVH_HPP_
+#define GFX_BVH_HPP_
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <utility>  // std::forward(), std::pair
+#include <vector>
+
+#include "math.hpp"
+#include "bounding_box.hpp"
+#include "frustum.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief A node of a Bvh, 32 bytes so that two fit into a cache line.
+ * @details Inner nodes refer to their first child, the second one directly
+ *          follows it. Leaves refer to a range of the primitives of the Bvh.
+ */
+struct BvhNode {
+	vec3 min;
+	std::uint32_t first;  // child or primitive
+	vec3 max;
+	std::uint32_t count;  // of primitives, 0 for inner nodes
+
+	bool isLeaf() const noexcept {
+		return count != 0;
+	}
+};
+
+/**
+ * @brief The bounds of a primitive a Bvh is built over.
+ */
+struct BvhPrimitive {
+	vec3 min;
+	vec3 max;
+};
+
+/**
+ * @brief A half-line, e.g. through a pixel of the viewport.
+ */
+struct Ray {
+	vec3 origin;
+	vec3 direction;  // normalized, so that distances are in model units
+};
+
+/**
+ * @brief The closest intersection of a Ray and a triangle of a TriangleBvh.
+ */
+struct RayHit {
+	std::size_t triangle;  // of the TriangleBvh
+	float distance;        // along the ray
+	vec3 point;
+};
+
+/**
+ * @brief How the builder of a Bvh decides which nodes become leaves.
+ */
+enum class BvhLeaves {
+	Sah,    // nodes of up to four primitives if the SAH rates them cheaper than a split
+	Packed  // all nodes of up to four primitives, for tests of four primitives at once
+};
+
+/**
+ * @brief A binary bounding volume hierarchy stored in a flat node array.
+ */
+class Bvh final {
+ public:
+	/**
+	 * @brief The maximum depth of the hierarchy, nodes at it are leaves regardless of their size.
+	 * @details Bounds the traversal stacks.
+	 */
+	static constexpr std::size_t maxDepth { 64 };
+
+	Bvh() = default;
+
+	/**
+	 * @brief Builds the hierarchy with the binned surface area heuristic.
+	 * @details The top levels are split on the calling thread, the subtrees
+	 *          below them are built in parallel on the ThreadPool.
+	 */
+	explicit Bvh(const std::vector<BvhPrimitive> &primitives, BvhLeaves leaves = BvhLeaves::Sah);
+	explicit Bvh(const std::vector<BoundingBox> &boxes, BvhLeaves leaves = BvhLeaves::Sah);
+
+	bool empty() const noexcept;
+	std::size_t size() const noexcept;  // number of primitives
+
+	const std::vector<BvhNode>& getNodes() const noexcept;
+
+	/**
+	 * @brief Returns the primitive indices in the order the leaves refer to them.
+	 */
+	const std::vector<std::uint32_t>& getPrimitives() const noexcept;
+
+	/**
+	 * @brief Visits the primitives of all leaves that pass @p test.
+	 * @param test Called with the min and max of each reached node, returns whether to descend.
+	 * @param visit Called with the index of each primitive of a reached leaf.
+	 */
+	template<typename Test, typename Visit>
+	void traverse(Test &&test, Visit &&visit) const {
+		traverseLeaves(std::forward<Test>(test), [&] (const BvhNode &leaf) {
+			for (std::uint32_t i = leaf.first; i < leaf.first + leaf.count; ++i) {
+				visit(_primitives[i]);
+			}
+		});
+	}
+
+	/**
+	 * @brief Returns the primitives whose bounds overlap @p box.
+	 */
+	std::vector<std::uint32_t> query(const BoundingBox &box) const;
+
+	/**
+	 * @brief Returns the primitives whose bounds are at least partially inside @p frustum.
+	 * @details Conservative like Frustum::intersects().
+	 */
+	std::vector<std::uint32_t> query(const Frustum &frustum) const;
+
+ private:
+	template<typename Test, typename Visit>
+	void traverseLeaves(Test &&test, Visit &&visit) const {
+		if (_nodes.empty()) {
+			return;
+		}
+
+		std::array<std::uint32_t, maxDepth + 1> stack;
+		std::size_t size { 0 };
+		stack[size++] = 0;
+		while (size > 0) {
+			const BvhNode &node { _nodes[stack[--size]] };
+			if (!test(node.min, node.max)) {
+				continue;
+			}
+
+			if (node.isLeaf()) {
+				visit(node);
+			} else {
+				assert(size + 2 <= stack.size() && "deeper than Bvh::maxDepth");
+				stack[size++] = node.first + 1;
+				stack[size++] = node.first;
+			}
+		}
+	}
+
+	std::vector<BvhNode> _nodes;             // the root comes first
+	std::vector<std::uint32_t> _primitives;  // in leaf order
+	std::vector<BvhPrimitive> _bounds;       // of the primitives in leaf order
+};
+
+/**
+ * @brief Up to four child boxes in a structure of arrays layout, collapsed from two levels of a Bvh.
+ */
+struct alignas(16) WideBvhNode {
+	std::array<float, 4> minX, minY, minZ;
+	std::array<float, 4> maxX, maxY, maxZ;
+	std::array<std::uint32_t, 4> first;  // wide node or first primitive of the Bvh
+	std::array<std::uint32_t, 4> count;  // of primitives, 0 for wide nodes
+	std::uint32_t size;                  // number of used slots
+};
+
+/**
+ * @brief The triangles of all meshes of a model in model space and a Bvh over them.
+ * @details Meshes drawn by several nodes of a SceneGraph are stored once per node.
+ */
+class TriangleBvh final {
+ public:
+	using Triangle = std::array<std::uint32_t, 3>;  // indices into the positions
+
+	/**
+	 * @param firstTriangles The index of the first triangle of each mesh or mesh instance.
+	 */
+	TriangleBvh(std::vector<vec3> positions, std::vector<Triangle> triangles,
+	            std::vector<std::uint32_t> firstTriangles);
+
+	const std::vector<vec3>& getPositions() const noexcept;
+	const std::vector<Triangle>& getTriangles() const noexcept;
+	const Bvh& getBvh() const noexcept;
+
+	/**
+	 * @brief Returns the mesh or mesh instance of a triangle and the index of the triangle within it.
+	 */
+	std::pair<std::size_t, std::size_t> locate(std::size_t triangle) const;
+
+	/**
+	 * @brief Returns the closest triangle hit by @p ray, front or back facing.
+	 * @details Traverses a four-wide version of the hierarchy and tests four
+	 *          boxes or the up to four triangles of a leaf at once with SSE.
+	 */
+	std::optional<RayHit> intersect(const Ray &ray) const;
+
+ private:
+	std::uint32_t collapse(std::uint32_t node);
+
+	std::vector<vec3> _positions;
+	std::vector<Triangle> _triangles;
+	std::vector<std::uint32_t> _firstTriangles;
+	Bvh _bvh;
+	std::vector<WideBvhNode> _wideNodes;  // the root comes first
+};
+
+}  // namespace bgl
+
+#endif  // GFX_BVH_HPP_
@@ -0,0 +1,402 @@
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>    // std::memcpy()
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+#include "cache.hpp"
+#include "mapped_file.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr char cache_magic[4] { 'B', 'G', 'L', 'C' };
+constexpr std::uint32_t cache_version { 8 };
+constexpr std::uint32_t no_material { ~0u };
+
+/**
+ * @brief Alignment of vertex and index data within the cache file.
+ * @details Mapped at a page boundary, the data can be handed to
+ *          glBufferData() straight from the page cache.
+ */
+constexpr std::uint64_t cache_alignment { 4096 };
+
+struct CacheKey {
+    std::uint32_t flags;
+    std::uint32_t options;
+    std::int64_t mtime;
+    std::uint64_t size;
+    std::string path;
+};
+
+struct MeshEntry {
+    std::uint32_t material;
+    std::uint32_t vertexFormat;  // VertexFormat
+    VertexQuantization quantization;
+    std::uint64_t vertexOffset;
+    std::uint64_t numVertices;
+    std::uint32_t indexType;  // GL_UNSIGNED_INT or GL_UNSIGNED_SHORT
+    std::uint64_t indexOffset;
+    std::uint64_t numIndices;
+    vec3 center;  // of the bounding box
+    vec3 size;
+};
+
+CacheKey get_cache_key(const std::filesystem::path &path, unsigned int flags, unsigned int options) {
+    return {
+        .flags = flags,
+        .options = options,
+        .mtime = static_cast<std::int64_t>(std::filesystem::last_write_time(path).time_since_epoch().count()),
+        .size = static_cast<std::uint64_t>(std::filesystem::file_size(path)),
+        .path = std::filesystem::canonical(path).string()
+    };
+}
+
+constexpr std::uint64_t align(std::uint64_t offset) noexcept {
+    return (offset + cache_alignment - 1) / cache_alignment * cache_alignment;
+}
+
+/*********************************************************
+ *                        Writing                        *
+ *********************************************************/
+template<typename T>
+void write(std::ostream &os, const T &value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+void write(std::ostream &os, const std::string &string) {
+    write<std::uint64_t>(os, string.size());
+    os.write(string.data(), string.size());
+}
+
+void write(std::ostream &os, const CacheKey &key) {
+    os.write(cache_magic, sizeof(cache_magic));
+    write(os, cache_version);
+    write(os, key.flags);
+    write(os, key.options);
+    write(os, key.mtime);
+    write(os, key.size);
+    write(os, key.path);
+}
+
+void write(std::ostream &os, const MaterialData &material) {
+    write(os, material.name);
+    write(os, material.diffuse);
+    write(os, material.ambient);
+    write(os, material.specular);
+    write(os, material.emissive);
+    write(os, material.shininess);
+    write(os, material.textures.diffuse.string());
+    write(os, material.textures.ambient.string());
+    write(os, material.textures.specular.string());
+    write(os, material.textures.emissive.string());
+}
+
+void write(std::ostream &os, const MeshEntry &entry) {
+    write(os, entry.material);
+    write(os, entry.vertexFormat);
+    write(os, entry.quantization);
+    write(os, entry.vertexOffset);
+    write(os, entry.numVertices);
+    write(os, entry.indexType);
+    write(os, entry.indexOffset);
+    write(os, entry.numIndices);
+    write(os, entry.center);
+    write(os, entry.size);
+}
+
+void write(std::ostream &os, const SceneGraph &graph) {
+    write<std::uint32_t>(os, graph.size());
+    for (std::uint32_t node = 0; node < graph.size(); ++node) {
+        write(os, graph.getParent(node));
+        write(os, graph.getTransform(node));
+        const std::vector<std::uint32_t> meshes { graph.getMeshes(node) };
+        write<std::uint32_t>(os, meshes.size());
+        for (const std::uint32_t mesh : meshes) {
+            write(os, mesh);
+        }
+    }
+}
+
+void write_at(std::ostream &os, std::uint64_t offset, const void *data, std::uint64_t size) {
+    const std::uint64_t position { static_cast<std::uint64_t>(os.tellp()) };
+    std::fill_n(std::ostreambuf_iterator<char>(os), offset - position, '\0');
+    os.write(static_cast<const char*>(data), size);
+}
+
+/**
+ * @brief Lays out the page aligned vertex and index data behind the header.
+ */
+std::vector<MeshEntry> get_mesh_entries(const std::vector<MeshView> &meshes, std::uint64_t header_size) {
+    constexpr std::uint64_t entry_size { 3 * sizeof(std::uint32_t) + sizeof(VertexQuantization) +
+                                         4 * sizeof(std::uint64_t) + 2 * sizeof(vec3) };
+    std::uint64_t offset { align(header_size + sizeof(std::uint32_t) + meshes.size() * entry_size) };
+
+    std::vector<MeshEntry> entries;
+    for (const MeshView &mesh : meshes) {
+        MeshEntry entry;
+        entry.material = mesh.materialIndex.value_or(no_material);
+        entry.vertexFormat = static_cast<std::uint32_t>(mesh.vertexFormat);
+        entry.quantization = mesh.quantization;
+        entry.numVertices = mesh.numVertices;
+        entry.vertexOffset = offset;
+        offset = align(offset + mesh.numVertices * GetVertexSize(mesh.vertexFormat));
+        entry.indexType = mesh.indexType;
+        entry.numIndices = mesh.numIndices;
+        entry.indexOffset = offset;
+        entry.center = mesh.boundingBox.getCenter();
+        entry.size = mesh.boundingBox.getSize();
+        offset = align(offset + mesh.numIndices * GetIndexSize(mesh.indexType));
+        entries.push_back(entry);
+    }
+    return entries;
+}
+
+/*********************************************************
+ *                        Reading                        *
+ *********************************************************/
+class cache_reader final {
+ public:
+    explicit cache_reader(const MappedFile &file)
+        : _file { file } {
+    }
+
+    template<typename T>
+    T read() {
+        static_assert(std::is_trivially_copyable_v<T>);
+        T value;
+        std::memcpy(&value, bytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    std::string read_string() {
+        const auto length { read<std::uint64_t>() };
+        const char *chars { reinterpret_cast<const char*>(bytes(length)) };
+        return { chars, chars + length };
+    }
+
+    /**
+     * @brief Returns @p count elements at @p offset without copying them.
+     */
+    template<typename T>
+    const T* view(std::uint64_t offset, std::uint64_t count) const {
+        if (offset % cache_alignment != 0 || offset > _file.size() ||
+            count > (_file.size() - offset) / sizeof(T)) {
+            throw std::runtime_error { "invalid data range" };
+        }
+        return reinterpret_cast<const T*>(_file.data() + offset);
+    }
+
+ private:
+    const std::byte* bytes(std::uint64_t size) {
+        if (size > _file.size() - _position) {
+            throw std::runtime_error { "truncated cache file" };
+        }
+        const std::byte *data { _file.data() + _position };
+        _position += size;
+        return data;
+    }
+
+    const MappedFile &_file;
+    std::uint64_t _position { 0 };
+};
+
+bool read_key(cache_reader &reader, const CacheKey &key) {
+    const auto magic { reader.read<std::array<char, 4>>() };
+    if (!std::equal(magic.begin(), magic.end(), cache_magic) ||
+        reader.read<std::uint32_t>() != cache_version) {
+        return false;
+    }
+
+    return reader.read<std::uint32_t>() == key.flags &&
+           reader.read<std::uint32_t>() == key.options &&
+           reader.read<std::int64_t>() == key.mtime &&
+           reader.read<std::uint64_t>() == key.size &&
+           reader.read_string() == key.path;
+}
+
+MaterialData read_material(cache_reader &reader) {
+    MaterialData material;
+    material.name = reader.read_string();
+    material.diffuse = reader.read<vec3>();
+    material.ambient = reader.read<vec3>();
+    material.specular = reader.read<vec3>();
+    material.emissive = reader.read<vec3>();
+    material.shininess = reader.read<float>();
+    material.textures.diffuse = reader.read_string();
+    material.textures.ambient = reader.read_string();
+    material.textures.specular = reader.read_string();
+    material.textures.emissive = reader.read_string();
+    return material;
+}
+
+/**
+ * @return Nothing if the model was cached with pre-transformed vertices.
+ */
+std::shared_ptr<SceneGraph> read_scene_graph(cache_reader &reader) {
+    const auto num_nodes { reader.read<std::uint32_t>() };
+    if (num_nodes == 0) {
+        return {};
+    }
+
+    const auto graph { std::make_shared<SceneGraph>() };
+    for (auto i = 0u; i < num_nodes; ++i) {
+        const auto parent { reader.read<std::uint32_t>() };
+        const auto transform { reader.read<mat4>() };
+        std::vector<std::uint32_t> meshes(reader.read<std::uint32_t>());
+        for (std::uint32_t &mesh : meshes) {
+            mesh = reader.read<std::uint32_t>();
+        }
+        graph->addNode(parent, transform, meshes);
+    }
+    return graph;
+}
+
+MeshView read_mesh(cache_reader &reader) {
+    MeshEntry entry;
+    entry.material = reader.read<std::uint32_t>();
+    entry.vertexFormat = reader.read<std::uint32_t>();
+    entry.quantization = reader.read<VertexQuantization>();
+    entry.vertexOffset = reader.read<std::uint64_t>();
+    entry.numVertices = reader.read<std::uint64_t>();
+    entry.indexType = reader.read<std::uint32_t>();
+    entry.indexOffset = reader.read<std::uint64_t>();
+    entry.numIndices = reader.read<std::uint64_t>();
+    entry.center = reader.read<vec3>();
+    entry.size = reader.read<vec3>();
+
+    const auto format { static_cast<VertexFormat>(entry.vertexFormat) };
+    if (format != VertexFormat::Float && format != VertexFormat::Compact) {
+        throw std::runtime_error { "invalid vertex format" };
+    }
+    if (entry.indexType != GL_UNSIGNED_INT && entry.indexType != GL_UNSIGNED_SHORT) {
+        throw std::runtime_error { "invalid index type" };
+    }
+
+    MeshView mesh {
+        .vertices = format == VertexFormat::Compact
+            ? static_cast<const void*>(reader.view<CompactVertex>(entry.vertexOffset, entry.numVertices))
+            : static_cast<const void*>(reader.view<Vertex>(entry.vertexOffset, entry.numVertices)),
+        .numVertices = entry.numVertices,
+        .indices = entry.indexType == GL_UNSIGNED_SHORT
+            ? static_cast<const void*>(reader.view<GLushort>(entry.indexOffset, entry.numIndices))
+            : static_cast<const void*>(reader.view<GLuint>(entry.indexOffset, entry.numIndices)),
+        .numIndices = entry.numIndices,
+        .materialIndex = {},
+        .vertexFormat = format,
+        .quantization = entry.quantization,
+        .indexType = entry.indexType,
+        .boundingBox = BoundingBox { entry.center, entry.size }
+    };
+    if (entry.material != no_material) {
+        mesh.materialIndex = entry.material;
+    }
+    return mesh;
+}
+
+}  // anonymous namespace
+
+std::filesystem::path GetCachePath(const std::filesystem::path &path) {
+    return std::filesystem::path { path }.concat(".bglcache");
+}
+
+std::optional<ModelData> LoadModelCache(const std::filesystem::path &path, unsigned int flags,
+                                        unsigned int options) {
+    const std::filesystem::path cache_path { GetCachePath(path) };
+    if (!std::filesystem::exists(cache_path)) {
+        return {};
+    }
+
+    try {
+        const auto file { std::make_shared<MappedFile>(cache_path) };
+        cache_reader reader { *file };
+        if (!read_key(reader, get_cache_key(path, flags, options))) {
+            std::cout << "cache " << cache_path << " is outdated" << std::endl;
+            return {};
+        }
+
+        ModelData data;
+        const auto center { reader.read<vec3>() };
+        const auto size { reader.read<vec3>() };
+        data.boundingBox = BoundingBox { center, size };
+
+        const auto num_materials { reader.read<std::uint32_t>() };
+        for (auto i = 0u; i < num_materials; ++i) {
+            data.materials.push_back(read_material(reader));
+        }
+        data.sceneGraph = read_scene_graph(reader);
+
+        const auto num_meshes { reader.read<std::uint32_t>() };
+        for (auto i = 0u; i < num_meshes; ++i) {
+            data.meshes.push_back(read_mesh(reader));
+        }
+
+        file->adviseSequential();
+        data.storage = file;
+        return data;
+    } catch (const std::exception &exception) {
+        std::cout << "warning: ignoring cache " << cache_path << ": " << exception.what() << std::endl;
+        return {};
+    }
+}
+
+void SaveModelCache(const std::filesystem::path &path, unsigned int flags, unsigned int options,
+                    const ModelData &data) {
+    const std::filesystem::path cache_path { GetCachePath(path) };
+    const std::filesystem::path temporary_path { std::filesystem::path { cache_path }.concat(".tmp") };
+
+    std::ostringstream header;
+    write(header, get_cache_key(path, flags, options));
+    write(header, data.boundingBox.getCenter());
+    write(header, data.boundingBox.getSize());
+    write<std::uint32_t>(header, data.materials.size());
+    for (const auto &material : data.materials) {
+        write(header, material);
+    }
+    if (data.sceneGraph) {
+        write(header, *data.sceneGraph);
+    } else {
+        write<std::uint32_t>(header, 0);
+    }
+
+    const std::string header_data { header.str() };
+    const std::vector<MeshEntry> entries { get_mesh_entries(data.meshes, header_data.size()) };
+
+    {
+        std::ofstream os { temporary_path, std::ios::binary | std::ios::trunc };
+        if (!os) {
+            throw std::runtime_error { "could not create " + temporary_path.string() };
+        }
+
+        os.write(header_data.data(), header_data.size());
+        write<std::uint32_t>(os, entries.size());
+        for (const auto &entry : entries) {
+            write(os, entry);
+        }
+
+        for (auto i = 0u; i < entries.size(); ++i) {
+            write_at(os, entries[i].vertexOffset, data.meshes[i].vertices,
+                     entries[i].numVertices * GetVertexSize(data.meshes[i].vertexFormat));
+            write_at(os, entries[i].indexOffset, data.meshes[i].indices,
+                     entries[i].numIndices * GetIndexSize(entries[i].indexType));
+        }
+
+        if (!os.flush()) {
+            throw std::runtime_error { "could not write " + temporary_path.string() };
+        }
+    }
+
+    // replaces the old cache file only once the new one is complete
+    std::filesystem::rename(temporary_path, cache_path);
+    std::cout << "wrote model cache " << cache_path << std::endl;
+}
+
+}  // namespace bgl
@@ -0,0 +1,39 @@
+/**
+ * @file cache.hpp
+ * @brief Versioned binary cache of post-processed model imports.
+ */
+#ifndef GFX_CACHE_HPP_
+#define GFX_CACHE_HPP_
+
+#include <filesystem>
+#include <optional>
+
+#include "importer.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Returns the path of the cache file that belongs to a model file.
+ */
+std::filesystem::path GetCachePath(const std::filesystem::path &path);
+
+/**
+ * @brief Loads the cached import of a model file.
+ * @details The cache is keyed by the canonical source path, its modification
+ *          time and size, the Assimp post processing @p flags and the
+ *          @p options of our own processing steps.
+ * @return The cached data or nothing if there is no valid cache entry.
+ */
+std::optional<ModelData> LoadModelCache(const std::filesystem::path &path, unsigned int flags,
+                                        unsigned int options);
+
+/**
+ * @brief Writes the import of a model file to its cache file.
+ */
+void SaveModelCache(const std::filesystem::path &path, unsigned int flags, unsigned int options,
+                    const ModelData &data);
+
+}  // namespace bgl
+
+#endif  // GFX_CACHE_HPP_
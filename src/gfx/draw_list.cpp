@@ -0,0 +1,33 @@
+#include <algorithm>
+#include <functional>  // std::less
+
+#include "draw_list.hpp"
+#include "material.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+const void* get_texture(const DrawCommand &command) noexcept {
+    return command.material ? command.material->textures.diffuse.get() : nullptr;
+}
+
+bool is_before(const DrawCommand &a, const DrawCommand &b) noexcept {
+    const std::less<const void*> less;
+    if (a.program != b.program) {
+        return less(a.program, b.program);
+    }
+    if (get_texture(a) != get_texture(b)) {
+        return less(get_texture(a), get_texture(b));
+    }
+    return less(a.material, b.material);
+}
+
+}  // anonymous namespace
+
+void SortDrawCommands(std::vector<DrawCommand> &commands) {
+    std::stable_sort(commands.begin(), commands.end(), is_before);
+}
+
+}  // namespace bgl
@@ -0,0 +1,32 @@
+/**
+ * @file draw_list.hpp
+ * @brief Draw commands ordered for few state changes.
+ */
+#ifndef GFX_DRAW_LIST_HPP_
+#define GFX_DRAW_LIST_HPP_
+
+#include <vector>
+
+class QOpenGLShaderProgram;
+
+
+namespace bgl {
+
+struct Material;
+struct Mesh;
+
+struct DrawCommand {
+    QOpenGLShaderProgram *program;
+    const Material *material;  // nullptr for meshes without a material
+    Mesh *mesh;
+};
+
+/**
+ * @brief Sorts draw commands by program, then diffuse texture, then material.
+ * @details Commands with equal state keep their order.
+ */
+void SortDrawCommands(std::vector<DrawCommand> &commands);
+
+}  // namespace bgl
+
+#endif  // GFX_DRAW_LIST_HPP_
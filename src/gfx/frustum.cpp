@@ -0,0 +1,147 @@
+#include <cmath>
+
+#if defined(__SSE2__)
+#include <xmmintrin.h>
+#endif  // __SSE2__
+
+#include "frustum.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+vec4 get_row(const mat4 &matrix, int row) noexcept {
+    return { matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row] };
+}
+
+}  // anonymous namespace
+
+/*********************************************************
+ *                       Box Array                       *
+ *********************************************************/
+void BoxArray::push_back(const BoundingBox &box) {
+    const vec3 center { box.getCenter() };
+    const vec3 extents { box.getSize() / 2.0f };
+    centerX.push_back(center.x);
+    centerY.push_back(center.y);
+    centerZ.push_back(center.z);
+    extentX.push_back(extents.x);
+    extentY.push_back(extents.y);
+    extentZ.push_back(extents.z);
+}
+
+void BoxArray::clear() noexcept {
+    for (std::vector<float> *values : { &centerX, &centerY, &centerZ, &extentX, &extentY, &extentZ }) {
+        values->clear();
+    }
+}
+
+std::size_t BoxArray::size() const noexcept {
+    return centerX.size();
+}
+
+/*********************************************************
+ *                        Frustum                        *
+ *********************************************************/
+
+/**
+ * @details Gribb and Hartmann: each plane is the sum or difference of the
+ *          fourth row and one of the other rows of the matrix.
+ */
+Frustum::Frustum(const mat4 &viewProjection) noexcept {
+    const vec4 w { get_row(viewProjection, 3) };
+    for (int i = 0; i < 3; ++i) {
+        const vec4 row { get_row(viewProjection, i) };
+        _planes[2 * i] = w + row;
+        _planes[2 * i + 1] = w - row;
+    }
+}
+
+bool Frustum::intersects(const vec3 &center, const vec3 &extents) const noexcept {
+    for (const vec4 &plane : _planes) {
+        const vec3 normal { plane.x, plane.y, plane.z };
+        const float distance { glm::dot(normal, center) + plane.w };
+        const float radius { glm::dot(glm::abs(normal), extents) };  // of the box along the normal
+        if (distance + radius < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool Frustum::intersects(const BoundingBox &box) const noexcept {
+    return intersects(box.getCenter(), box.getSize() / 2.0f);
+}
+
+bool Frustum::intersects(const BoundingBox &box, const mat4 &transform) const noexcept {
+    const vec3 extents { box.getSize() / 2.0f };
+    const vec3 center { transform * vec4 { box.getCenter(), 1.0f } };
+
+    // Arvo: the extents of the transformed box along each axis
+    vec3 transformed_extents { 0.0f };
+    for (int row = 0; row < 3; ++row) {
+        for (int column = 0; column < 3; ++column) {
+            transformed_extents[row] += std::abs(transform[column][row]) * extents[column];
+        }
+    }
+    return intersects(center, transformed_extents);
+}
+
+std::size_t Frustum::cull(const BoxArray &boxes, std::vector<std::uint8_t> &visible) const {
+    const std::size_t count { boxes.size() };
+    visible.resize(count);
+
+    std::size_t num_visible { 0 };
+    std::size_t i { 0 };
+#if defined(__SSE2__)
+    struct simd_plane {
+        __m128 x, y, z, w;        // the plane
+        __m128 absX, absY, absZ;  // the absolute normal
+    };
+
+    std::array<simd_plane, 6> planes;
+    for (auto p = 0u; p < planes.size(); ++p) {
+        const vec4 &plane { _planes[p] };
+        planes[p] = {
+            _mm_set1_ps(plane.x), _mm_set1_ps(plane.y), _mm_set1_ps(plane.z), _mm_set1_ps(plane.w),
+            _mm_set1_ps(std::abs(plane.x)), _mm_set1_ps(std::abs(plane.y)), _mm_set1_ps(std::abs(plane.z))
+        };
+    }
+
+    const __m128 zero { _mm_setzero_ps() };
+    for (; i + 4 <= count; i += 4) {
+        const __m128 cx { _mm_loadu_ps(&boxes.centerX[i]) };
+        const __m128 cy { _mm_loadu_ps(&boxes.centerY[i]) };
+        const __m128 cz { _mm_loadu_ps(&boxes.centerZ[i]) };
+        const __m128 ex { _mm_loadu_ps(&boxes.extentX[i]) };
+        const __m128 ey { _mm_loadu_ps(&boxes.extentY[i]) };
+        const __m128 ez { _mm_loadu_ps(&boxes.extentZ[i]) };
+
+        __m128 outside { zero };
+        for (const simd_plane &plane : planes) {
+            const __m128 distance { _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.x, cx), _mm_mul_ps(plane.y, cy)),
+                                               _mm_add_ps(_mm_mul_ps(plane.z, cz), plane.w)) };
+            const __m128 radius { _mm_add_ps(_mm_add_ps(_mm_mul_ps(plane.absX, ex), _mm_mul_ps(plane.absY, ey)),
+                                             _mm_mul_ps(plane.absZ, ez)) };
+            outside = _mm_or_ps(outside, _mm_cmplt_ps(_mm_add_ps(distance, radius), zero));
+        }
+
+        const int mask { _mm_movemask_ps(outside) };
+        for (int lane = 0; lane < 4; ++lane) {
+            visible[i + lane] = ((mask >> lane) & 1) == 0;
+            num_visible += visible[i + lane];
+        }
+    }
+#endif  // __SSE2__
+
+    for (; i < count; ++i) {
+        const vec3 center { boxes.centerX[i], boxes.centerY[i], boxes.centerZ[i] };
+        const vec3 extents { boxes.extentX[i], boxes.extentY[i], boxes.extentZ[i] };
+        visible[i] = intersects(center, extents);
+        num_visible += visible[i];
+    }
+    return num_visible;
+}
+
+}  // namespace bgl
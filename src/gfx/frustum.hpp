@@ -0,0 +1,66 @@
+/**
+ * @file frustum.hpp
+ * @brief View frustum culling of bounding boxes.
+ */
+#ifndef GFX_FRUSTUM_HPP_
+#define GFX_FRUSTUM_HPP_
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+#include "bounding_box.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Bounding boxes in a structure of arrays layout, so several can be tested at once.
+ */
+struct BoxArray {
+	std::vector<float> centerX, centerY, centerZ;
+	std::vector<float> extentX, extentY, extentZ;  // half the sizes
+
+	void push_back(const BoundingBox &box);
+	void clear() noexcept;
+	std::size_t size() const noexcept;
+};
+
+/**
+ * @brief The six planes of a view frustum, pointing inwards.
+ */
+class Frustum final {
+ public:
+	/**
+	 * @brief Extracts the planes of a (model) view projection matrix.
+	 */
+	explicit Frustum(const mat4 &viewProjection) noexcept;
+
+	/**
+	 * @brief Returns whether a box is at least partially inside the frustum.
+	 * @details The test is conservative: boxes near a corner of the frustum
+	 *          may be reported as visible although they are outside.
+	 */
+	bool intersects(const vec3 &center, const vec3 &extents /* half the size */) const noexcept;
+	bool intersects(const BoundingBox &box) const noexcept;
+
+	/**
+	 * @brief Returns whether a box, transformed by @p transform, is at least partially inside the frustum.
+	 */
+	bool intersects(const BoundingBox &box, const mat4 &transform) const noexcept;
+
+	/**
+	 * @brief Tests all boxes against the frustum, four at a time with SSE2.
+	 * @param[out] visible 1 for each box that is at least partially inside, 0 for the others.
+	 * @return The number of visible boxes.
+	 */
+	std::size_t cull(const BoxArray &boxes, std::vector<std::uint8_t> &visible) const;
+
+ private:
+	std::array<vec4, 6> _planes;  // (normal, distance)
+};
+
+}  // namespace bgl
+
+#endif  // GFX_FRUSTUM_HPP_
@@ -2,23 +2,18 @@
 #include <sstream>
 
 #include "gfx.hpp"
+#include "gl_debug.hpp"
 
 
 namespace bgl {
 
 // vao must be bound!
-void set_va_attribute(GLint location, GLsizei size, GLenum type, GLsizei stride, GLsizei offset) {
+void set_va_attribute(GLint location, GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                      GLboolean normalized) {
     glEnableVertexAttribArray(location);
     // TODO: check if location < 0
-    glVertexAttribPointer(location, size, type, GL_FALSE, stride, reinterpret_cast<void*>(offset));
-
-    const GLenum error { glGetError() };
-    if (error != GL_NO_ERROR) {
-        std::ostringstream oss;
-        oss << "glVertexAttribPointer() failed for location "
-            << location << " due to " << gluErrorString(error);
-        throw std::runtime_error { oss.str() };
-    }
+    glVertexAttribPointer(location, size, type, normalized, stride, reinterpret_cast<void*>(offset));
+    CheckGLError("glVertexAttribPointer()");
 }
 
 std::shared_ptr<QOpenGLShaderProgram> LoadProgram(const std::filesystem::path &vs, const std::filesystem::path &fs) {
@@ -14,7 +14,8 @@
 
 namespace bgl {
 
-void set_va_attribute(GLint location, GLsizei size, GLenum type, GLsizei stride, GLsizei offset);
+void set_va_attribute(GLint location, GLsizei size, GLenum type, GLsizei stride, GLsizei offset,
+                      GLboolean normalized = GL_FALSE);
 std::shared_ptr<QOpenGLShaderProgram> LoadProgram(const std::filesystem::path &vs, const std::filesystem::path &fs);
 std::shared_ptr<QOpenGLShaderProgram> LoadProgram(const std::initializer_list<std::filesystem::path> &shaders);
 
@@ -0,0 +1,70 @@
+#include <cstring>  // std::strlen()
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "gl_debug.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+std::mutex output_mutex;
+
+const char* get_severity(GLenum severity) noexcept {
+    switch (severity) {
+        case GL_DEBUG_SEVERITY_HIGH:
+            return "error";
+        case GL_DEBUG_SEVERITY_MEDIUM:
+            return "warning";
+        default:
+            return "note";
+    }
+}
+
+/**
+ * @note Without GL_DEBUG_OUTPUT_SYNCHRONOUS the driver may call this from any thread.
+ */
+void GLAPIENTRY on_debug_message(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length,
+                                 const GLchar *message, const void *user_data) {
+    if (severity == GL_DEBUG_SEVERITY_NOTIFICATION) {
+        return;  // e.g. buffer placement hints
+    }
+
+    const std::string_view text { message, length < 0 ? std::strlen(message) : static_cast<std::size_t>(length) };
+    const std::lock_guard lock { output_mutex };
+    std::cout << get_severity(severity) << ": OpenGL: " << text
+              << (type == GL_DEBUG_TYPE_ERROR ? " (error)" : "") << std::endl;
+}
+
+}  // anonymous namespace
+
+bool EnableDebugOutput() {
+    if (!GLEW_VERSION_4_3 && !GLEW_KHR_debug) {
+        std::cout << "warning: no OpenGL debug output, errors are not reported" << std::endl;
+        return false;
+    }
+
+    glEnable(GL_DEBUG_OUTPUT);
+#ifdef BGL_CHECK_GL_ERRORS
+    glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);  // reports errors within the call that caused them
+#endif  // BGL_CHECK_GL_ERRORS
+    glDebugMessageCallback(on_debug_message, nullptr);
+    return true;
+}
+
+#ifdef BGL_CHECK_GL_ERRORS
+void CheckGLError(const char *function) {
+    const GLenum error { glGetError() };
+    if (error != GL_NO_ERROR) {
+        std::ostringstream oss;
+        oss << function << " failed due to " << gluErrorString(error);
+        throw std::runtime_error { oss.str() };
+    }
+}
+#endif  // BGL_CHECK_GL_ERRORS
+
+}  // namespace bgl
@@ -0,0 +1,37 @@
+/**
+ * @file gl_debug.hpp
+ * @brief Reporting of OpenGL errors without stalling the command stream.
+ * @details Release builds leave error reporting to the debug output of the
+ *          driver (GL_KHR_debug). Builds with BGL_CHECK_GL_ERRORS defined
+ *          (make GL_CHECKS=1) additionally validate each checked call with
+ *          glGetError() and throw on errors.
+ */
+#ifndef GFX_GL_DEBUG_HPP_
+#define GFX_GL_DEBUG_HPP_
+
+#include "gl.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Logs errors and warnings of the OpenGL context through a debug message callback.
+ * @return Whether the context supports debug output.
+ * @note The OpenGL context has to be current.
+ */
+bool EnableDebugOutput();
+
+#ifdef BGL_CHECK_GL_ERRORS
+/**
+ * @brief Throws if the last OpenGL call, @p function, failed.
+ */
+void CheckGLError(const char *function);
+#else
+inline void CheckGLError(const char * /* function */) noexcept {
+    // reported by the debug output instead of a glGetError() round trip
+}
+#endif  // BGL_CHECK_GL_ERRORS
+
+}  // namespace bgl
+
+#endif  // GFX_GL_DEBUG_HPP_
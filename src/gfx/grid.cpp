@@ -1,13 +1,12 @@
 #include "grid.hpp"
 #include "gfx.hpp"
+#include "uniforms.hpp"
 
 #include <QMatrix4x4>
 
 
 namespace bgl {
 
-enum locations { MVP = 0 , color, position };
-
 Grid::Grid(GLfloat size, std::size_t num_cells)
     : _cell_size { size },
       _num_cells { num_cells } {
@@ -17,6 +16,10 @@ Grid::Grid(GLfloat size, std::size_t num_cells)
     create_vbo();
     create_ibo();
     create_vao();
+
+    const UniformTable uniforms { *_program };
+    _locations.MVP = uniforms.getLocation("MVP");
+    _locations.color = uniforms.getLocation("color");
 }
 
 void Grid::create_vbo() {
@@ -89,8 +92,8 @@ void Grid::render(const mat4 &PV) {
     QMatrix4x4 matrix(glm::value_ptr(PV * glm::translate(_translation)));
 
     _program->bind();
-    _program->setUniformValue(_program->attributeLocation("MVP"), matrix.transposed());
-    _program->setUniformValue(_program->attributeLocation("color"), white.x, white.y, white.z);
+    _program->setUniformValue(_locations.MVP, matrix.transposed());
+    _program->setUniformValue(_locations.color, white.x, white.y, white.z);
     _meshes[0].render(GL_LINES);
     _program->release();
 }
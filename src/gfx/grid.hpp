@@ -20,6 +20,11 @@ class Grid final : public Model {
     const GLfloat _cell_size;
     const std::size_t _num_cells;
     vec3 _translation;
+
+    struct {
+        GLint MVP { -1 };
+        GLint color { -1 };
+    } _locations;
 };
 
 }  // namespace bgl
@@ -5,16 +5,34 @@
 #include <assimp/scene.h>
 
 #include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <iomanip>    // std::quoted()
 #include <iostream>
+#include <limits>
 #include <list>
+#include <map>
+#include <memory>     // std::shared_ptr
+#include <mutex>
+#include <optional>
+#include <set>
+#include <sstream>
 #include <string>
 
 #include <assimp/Importer.hpp>
+#include <assimp/ProgressHandler.hpp>
 
 #include "model.hpp"
 #include "box.hpp"
 #include "importer.hpp"  //  TODO
 #include "gfx.hpp"       //  TODO
+#include "cache.hpp"
+#include "memory.hpp"
+#include "mesh_optimizer.hpp"
+#include "texture_cache.hpp"
+#include "thread_pool.hpp"
 
 #include <QImage>
 #include <QMatrix4x4>
@@ -34,156 +52,627 @@ inline bool has_material(const aiMesh &mesh) noexcept {
     return mesh.mMaterialIndex != 0;
 }
 
+inline void report(const ProgressCallback &progress, LoadStage stage, float value) {
+    if (progress) {
+        progress(stage, value);
+    }
+}
+
+constexpr unsigned int import_flags {
+    aiProcess_Triangulate |
+    aiProcess_GenSmoothNormals |
+    aiProcess_JoinIdenticalVertices
+};
+
+unsigned int get_import_flags(const ImportOptions &options) noexcept {
+    return options.preTransformVertices ? import_flags | aiProcess_PreTransformVertices : import_flags;
+}
+
+/**
+ * @brief Bits of our own processing steps that change the imported geometry.
+ */
+enum cache_option : unsigned int {
+    optimized_meshes = 1u << 0,
+    compact_vertices = 1u << 1
+};
+
+unsigned int get_cache_options(const ImportOptions &options) noexcept {
+    return (options.optimizeMeshes ? optimized_meshes : 0u) |
+           (options.vertexFormat == VertexFormat::Compact ? compact_vertices : 0u);
+}
+
 /*********************************************************
  *                     OpenGL Code                       *
  *********************************************************/
-QOpenGLBuffer create_vbo(QOpenGLBuffer &vbo, const aiMesh &mesh) {
+void create_vbo(QOpenGLBuffer &vbo, const void *vertices, std::size_t count, VertexFormat format) {
+    vbo.bind();
+    vbo.allocate(vertices, static_cast<int>(count * GetVertexSize(format)));
+    vbo.release();
+}
+
+void create_ibo(QOpenGLBuffer &ibo, const void *indices, std::size_t count, GLenum type) {
+    ibo.bind();
+    ibo.allocate(indices, static_cast<int>(count * GetIndexSize(type)));
+    ibo.release();
+}
+
+// program must be bound!!!!
+void create_vao(QOpenGLVertexArrayObject &vao, QOpenGLBuffer &vbo, QOpenGLShaderProgram &program,
+                VertexFormat format, QOpenGLBuffer *ibo = nullptr, bool instanced = false) {
+    program.bind();
+    vao.bind();
     vbo.bind();
-    vbo.allocate(sizeof(Vertex) * mesh.mNumVertices);
-    auto buffer { reinterpret_cast<Vertex*>(vbo.map(QOpenGLBuffer::ReadWrite)) };
-    if (buffer == nullptr) {
-        vbo.release();
-        throw std::runtime_error{"could not map VBO"};
+    if (ibo) {
+        ibo->bind();  // captured by the VAO
+    }
+    const GLint position { program.attributeLocation("position") };
+    const GLint normal { program.attributeLocation("normal") };
+    const GLint texcoords { program.attributeLocation("texcoords") };
+    if (format == VertexFormat::Compact) {
+        const auto stride{sizeof(CompactVertex)};
+        set_va_attribute(position, 3, GL_UNSIGNED_SHORT, stride, offsetof(CompactVertex, position), GL_TRUE);
+        set_va_attribute(normal, 2, GL_SHORT, stride, offsetof(CompactVertex, normal), GL_TRUE);
+        set_va_attribute(texcoords, 2, GL_UNSIGNED_SHORT, stride, offsetof(CompactVertex, texcoords), GL_TRUE);
+    } else {
+        const auto stride{sizeof(Vertex)};
+        set_va_attribute(position, 3, GL_FLOAT, stride, offsetof(Vertex, position));
+        set_va_attribute(normal, 3, GL_FLOAT, stride, offsetof(Vertex, normal));
+        set_va_attribute(texcoords, 2, GL_FLOAT, stride, offsetof(Vertex, texcoords));
+    }
+    if (instanced) {
+        SetupInstanceAttributes();
+    }
+    vao.release();
+    vbo.release();
+    if (ibo) {
+        ibo->release();
+    }
+    program.release();
+}
+
+constexpr std::size_t align_index_offset(std::size_t offset) noexcept {
+    return (offset + sizeof(GLuint) - 1) / sizeof(GLuint) * sizeof(GLuint);
+}
+
+/*********************************************************
+ *                      Mesh Arenas                      *
+ *********************************************************/
+struct arena_size {
+    std::size_t vertices { 0 };  // in bytes
+    std::size_t indices { 0 };   // in bytes
+};
+
+/**
+ * @brief Location of a mesh within the buffers of its MeshArena.
+ */
+struct arena_range {
+    std::size_t vertexOffset;  // in bytes
+    std::size_t indexOffset;   // in bytes
+};
+
+struct arena_layout {
+    std::map<VertexFormat, arena_size> arenas;
+    std::vector<arena_range> ranges;  // of each mesh
+};
+
+/**
+ * @brief Lays out all meshes with the same vertex format back to back in one arena.
+ * @return The layout or nothing if an arena exceeds what QOpenGLBuffer can allocate.
+ */
+std::optional<arena_layout> get_arena_layout(const std::vector<MeshView> &meshes) {
+    constexpr auto max_size { static_cast<std::size_t>(std::numeric_limits<int>::max()) };
+
+    arena_layout layout;
+    for (const MeshView &mesh : meshes) {
+        arena_size &size { layout.arenas[mesh.vertexFormat] };
+        size.indices = align_index_offset(size.indices);  // 16 and 32-bit indices share the buffer
+        layout.ranges.push_back({ size.vertices, size.indices });
+        size.vertices += mesh.numVertices * GetVertexSize(mesh.vertexFormat);
+        size.indices += mesh.numIndices * GetIndexSize(mesh.indexType);
+        if (size.vertices > max_size || size.indices > max_size) {
+            return {};
+        }
+    }
+    return layout;
+}
+
+std::vector<Mesh> upload_shared_meshes(const std::vector<MeshView> &data, const arena_layout &layout,
+                                       QOpenGLShaderProgram &program, const ProgressCallback &progress) {
+    std::map<VertexFormat, std::shared_ptr<MeshArena>> arenas;
+    for (const auto &[format, size] : layout.arenas) {
+        const auto arena { std::make_shared<MeshArena>() };
+        arena->_vertexFormat = format;
+        create_vbo(arena->_vbo, nullptr, size.vertices / GetVertexSize(format), format);
+        arena->_ibo.bind();
+        arena->_ibo.allocate(static_cast<int>(size.indices));
+        arena->_ibo.release();
+        arenas.emplace(format, arena);
+    }
+
+    std::vector<Mesh> meshes;
+    meshes.reserve(data.size());
+    for (auto i = 0u; i < data.size(); ++i) {
+        const MeshView &view { data[i] };
+        const arena_range &range { layout.ranges[i] };
+        const std::shared_ptr<MeshArena> &arena { arenas.at(view.vertexFormat) };
+
+        const std::size_t vertex_size { GetVertexSize(view.vertexFormat) };
+        arena->_vbo.bind();
+        arena->_vbo.write(static_cast<int>(range.vertexOffset), view.vertices,
+                          static_cast<int>(view.numVertices * vertex_size));
+        arena->_vbo.release();
+        arena->_ibo.bind();
+        arena->_ibo.write(static_cast<int>(range.indexOffset), view.indices,
+                          static_cast<int>(view.numIndices * GetIndexSize(view.indexType)));
+        arena->_ibo.release();
+
+        Mesh &mesh { meshes.emplace_back(arena) };
+        mesh._baseVertex = static_cast<GLint>(range.vertexOffset / vertex_size);
+        mesh._firstIndex = range.indexOffset;
+        mesh._numIndices = static_cast<GLsizei>(view.numIndices);
+        report(progress, LoadStage::Uploading, static_cast<float>(i + 1) / data.size());
+    }
+
+    for (const auto &[format, arena] : arenas) {
+        create_vao(arena->_vao, arena->_vbo, program, format, &arena->_ibo);
+        create_vao(arena->_instancedVao, arena->_vbo, program, format, &arena->_ibo, true);
+    }
+    std::cout << "packed " << data.size() << " meshes into " << arenas.size() << " shared buffers" << std::endl;
+    return meshes;
+}
+
+std::vector<Mesh> upload_separate_meshes(const std::vector<MeshView> &data, QOpenGLShaderProgram &program,
+                                         const ProgressCallback &progress) {
+    std::vector<Mesh> meshes(data.size());
+    for (auto i = 0u; i < meshes.size(); ++i) {
+        create_vbo(meshes[i]._vbo, data[i].vertices, data[i].numVertices, data[i].vertexFormat);
+        create_ibo(meshes[i]._ibo, data[i].indices, data[i].numIndices, data[i].indexType);
+        create_vao(meshes[i]._vao, meshes[i]._vbo, program, data[i].vertexFormat);
+        create_vao(meshes[i]._instancedVao, meshes[i]._vbo, program, data[i].vertexFormat, nullptr, true);
+        report(progress, LoadStage::Uploading, static_cast<float>(i + 1) / meshes.size());
+    }
+    return meshes;
+}
+
+/**
+ * @note The views are passed to glBufferData() as they are, so mapped cache
+ *       files are uploaded without an intermediate copy.
+ */
+void upload_meshes(Model &model, const std::vector<MeshView> &data, QOpenGLShaderProgram &program,
+                   const ImportOptions &options, const ProgressCallback &progress) {
+    const std::optional<arena_layout> layout { options.shareBuffers ? get_arena_layout(data) : std::nullopt };
+    if (options.shareBuffers && !layout.has_value()) {
+        std::cout << "warning: model too large for shared buffers" << std::endl;
+    }
+
+    std::vector<Mesh> &meshes { model.getMeshes() };
+    meshes = layout.has_value() ? upload_shared_meshes(data, layout.value(), program, progress)
+                                : upload_separate_meshes(data, program, progress);
+
+    std::size_t bytes_saved { 0 };
+    for (auto i = 0u; i < meshes.size(); ++i) {
+        meshes[i]._materialIndex = data[i].materialIndex;
+        meshes[i]._vertexFormat = data[i].vertexFormat;
+        meshes[i]._quantization = data[i].quantization;
+        meshes[i]._indexType = data[i].indexType;
+        meshes[i]._boundingBox = data[i].boundingBox;
+        if (data[i].indexType == GL_UNSIGNED_SHORT) {
+            bytes_saved += data[i].numIndices * (sizeof(GLuint) - sizeof(GLushort));
+        }
+    }
+
+    model.invalidateDrawList();  // the meshes were replaced
+    model.setIndexBytesSaved(bytes_saved);
+    std::cout << "16-bit indices saved " << bytes_saved / 1024 << " KiB" << std::endl;
+}
+
+/*********************************************************
+ *                     Assimp Mesh Code                  *
+ *********************************************************/
+/**
+ * @brief Forwards Assimp's import progress as LoadStage::Parsing and LoadStage::PostProcessing.
+ */
+class progress_handler final : public Assimp::ProgressHandler {
+ public:
+    explicit progress_handler(const ProgressCallback &progress)
+        : _progress { progress } {
     }
 
+    bool Update(float /*percentage*/) override {
+        return true;  // never cancels the import, the steps are reported below
+    }
+
+    void UpdateFileRead(int step, int num_steps) override {
+        report(_progress, LoadStage::Parsing, get_fraction(step, num_steps));
+    }
+
+    void UpdatePostProcess(int step, int num_steps) override {
+        report(_progress, LoadStage::PostProcessing, get_fraction(step, num_steps));
+    }
+
+ private:
+    static float get_fraction(int step, int num_steps) noexcept {
+        return num_steps > 0 ? std::clamp(static_cast<float>(step) / num_steps, 0.0f, 1.0f) : 1.0f;
+    }
+
+    const ProgressCallback &_progress;
+};
+
+/**
+ * @note The returned scene is owned by @p importer.
+ */
+const aiScene& importScene(Assimp::Importer &importer, const std::filesystem::path &path, unsigned int flags) {
+    if (flags & aiProcess_PreTransformVertices) {
+        importer.SetPropertyInteger(AI_CONFIG_PP_PTV_NORMALIZE, 1);
+    }
+    const aiScene *scene{importer.ReadFile(path.string(), flags)};
+    return scene ? *scene
+                 : throw std::runtime_error{importer.GetErrorString()};
+}
+
+MeshData load_mesh(const aiMesh &mesh) {
+    MeshData data;
+    data.vertices.resize(mesh.mNumVertices);
     for (auto i = 0u; i < mesh.mNumVertices; ++i) {
-        buffer[i].normal = vec3{mesh.mNormals[i].x, mesh.mNormals[i].y, mesh.mNormals[i].z};
-        buffer[i].position = vec3{mesh.mVertices[i].x, mesh.mVertices[i].y, mesh.mVertices[i].z};
+        data.vertices[i].normal = vec3{mesh.mNormals[i].x, mesh.mNormals[i].y, mesh.mNormals[i].z};
+        data.vertices[i].position = vec3{mesh.mVertices[i].x, mesh.mVertices[i].y, mesh.mVertices[i].z};
+        data.vertices[i].texcoords = vec2{};
     }
 
     if (is_textured(mesh)) {
         if (mesh.mNumUVComponents[0] != 2) {
-            vbo.unmap();
-            vbo.release();
             throw std::runtime_error{"only one texture channel supported"};
         }
         for (unsigned int i = 0; i < mesh.mNumVertices; ++i) {
-            buffer[i].texcoords = vec2{mesh.mTextureCoords[0][i].x, 1.0 - mesh.mTextureCoords[0][i].y};
+            data.vertices[i].texcoords = vec2{mesh.mTextureCoords[0][i].x, 1.0 - mesh.mTextureCoords[0][i].y};
         }
     }
 
-    if (!vbo.unmap()) {
-        vbo.release();
-        throw std::runtime_error{"could not unmap VBO"};
+    data.indices.reserve(mesh.mNumFaces * 3);
+    for (auto i = 0u; i < mesh.mNumFaces; ++i) {
+        assert(mesh.mFaces[i].mNumIndices == 3);
+        data.indices.insert(data.indices.end(), mesh.mFaces[i].mIndices, mesh.mFaces[i].mIndices + 3);
     }
-    vbo.release();
-    return vbo;
+
+    if (has_material(mesh)) {
+        data.materialIndex = mesh.mMaterialIndex;
+    }
+    return data;
 }
 
-void create_ibo(QOpenGLBuffer &ibo, const aiMesh &mesh) {
-    ibo.bind();
-    ibo.allocate(sizeof(GLuint) * mesh.mNumFaces * 3);
-    GLuint *buffer {reinterpret_cast<GLuint*>(ibo.map(QOpenGLBuffer::WriteOnly))};
-    if (buffer == nullptr) {
-        throw std::runtime_error{"could not map IBO"};
+/**
+ * @brief Reorders the triangles and vertices of a mesh for the vertex caches.
+ * @return The vertex cache statistics before the optimization.
+ */
+VertexCacheStats optimize_mesh(MeshData &mesh) {
+    const VertexCacheStats stats { AnalyzeVertexCache(mesh.indices, mesh.vertices.size()) };
+    OptimizeVertexCache(mesh.indices, mesh.vertices.size());
+    OptimizeVertexFetch(mesh.vertices, mesh.indices);
+    return stats;
+}
+
+void print_vertex_cache_stats(const std::vector<VertexCacheStats> &before,
+                              const std::vector<VertexCacheStats> &after) {
+    VertexCacheStats total_before;
+    VertexCacheStats total_after;
+    for (auto i = 0u; i < before.size(); ++i) {
+        total_before += before[i];
+        total_after += after[i];
     }
 
-    for (auto i = 0u; i < mesh.mNumFaces; ++i) {
-        assert(mesh.mFaces[i].mNumIndices == 3);
-        std::copy_n(mesh.mFaces[i].mIndices, 3, buffer);
-        buffer += 3;
+    std::cout << std::fixed << std::setprecision(3)
+              << "optimized vertex cache: ACMR " << total_before.getACMR() << " -> " << total_after.getACMR()
+              << ", ATVR " << total_before.getATVR() << " -> " << total_after.getATVR()
+              << std::defaultfloat << std::endl;
+}
+
+/**
+ * @brief Converts all meshes of a scene in parallel.
+ * @details This is CPU work only, the OpenGL upload happens in one pass
+ *          afterwards (see upload_meshes()).
+ */
+std::vector<MeshData> load_meshes(const aiScene &scene, const ImportOptions &options,
+                                  const ProgressCallback &progress) {
+    if (scene.mNumMeshes == 0) {
+        throw std::runtime_error{"empty model"};
     }
 
-    if (!ibo.unmap()) {
-        throw std::runtime_error{"could not unmap IBO"};
+    std::cout << "loading " << scene.mNumMeshes << " meshes" << std::endl;
+
+    std::vector<MeshData> meshes(scene.mNumMeshes);
+    std::vector<VertexCacheStats> before(meshes.size());
+    std::vector<VertexCacheStats> after(meshes.size());
+    std::atomic<std::size_t> num_done { 0 };
+    ParallelFor(meshes.size(), [&] (std::size_t i) {
+        meshes[i] = load_mesh(*scene.mMeshes[i]);
+        if (options.optimizeMeshes) {
+            before[i] = optimize_mesh(meshes[i]);
+            after[i] = AnalyzeVertexCache(meshes[i].indices, meshes[i].vertices.size());
+        }
+        report(progress, LoadStage::BuildingBuffers, static_cast<float>(++num_done) / meshes.size());
+    });
+
+    if (options.optimizeMeshes) {
+        print_vertex_cache_stats(before, after);
     }
-    ibo.release();
+    return meshes;
 }
 
-// program must be bound!!!!
-void create_vao(QOpenGLVertexArrayObject &vao, QOpenGLBuffer &vbo, QOpenGLShaderProgram &program) {
-    program.bind();
-    vao.bind();
-    vbo.bind();
-    const auto stride{sizeof(Vertex)};
-    set_va_attribute(program.attributeLocation("position"), 3, GL_FLOAT, stride, offsetof(Vertex, position));
-    set_va_attribute(program.attributeLocation("normal"), 3, GL_FLOAT, stride, offsetof(Vertex, normal));
-    set_va_attribute(program.attributeLocation("texcoords"), 2, GL_FLOAT, stride, offsetof(Vertex, texcoords));
-    vao.release();
-    vbo.release();
-    program.release();
+BoundingBox calculate_bounding_box(const MeshData &mesh) noexcept {
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (const Vertex &vertex : mesh.vertices) {
+        min = glm::min(min, vertex.position);
+        max = glm::max(max, vertex.position);
+    }
+
+    const vec3 size { max - min };
+    const vec3 center { min + (size / 2.0f) };
+    return BoundingBox { center, size };
+}
+
+/**
+ * @brief Returns the box enclosing the boxes of all meshes.
+ */
+BoundingBox calculate_bounding_box(const std::vector<MeshView> &meshes) noexcept {
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (const MeshView &mesh : meshes) {
+        const vec3 half_size { mesh.boundingBox.getSize() / 2.0f };
+        min = glm::min(min, mesh.boundingBox.getCenter() - half_size);
+        max = glm::max(max, mesh.boundingBox.getCenter() + half_size);
+    }
+
+    const vec3 size { max - min };
+    const vec3 center { min + (size / 2.0f) };
+    return BoundingBox { center, size };
+}
+
+std::vector<MeshView> get_views(const std::vector<MeshData> &meshes) {
+    std::vector<MeshView> views(meshes.size());
+    ParallelFor(meshes.size(), [&] (std::size_t i) {
+        views[i] = {
+            .vertices = meshes[i].vertices.data(),
+            .numVertices = meshes[i].vertices.size(),
+            .indices = meshes[i].indices.data(),
+            .numIndices = meshes[i].indices.size(),
+            .materialIndex = meshes[i].materialIndex,
+            .vertexFormat = VertexFormat::Float,
+            .quantization = {},
+            .indexType = GL_UNSIGNED_INT,
+            .boundingBox = calculate_bounding_box(meshes[i]) };
+    });
+    return views;
 }
 
 /*********************************************************
- *                     Assimp Mesh Code                  *
+ *                    Scene Graph Code                   *
  *********************************************************/
-const aiScene *importScene(const std::filesystem::path &path) {
-    if (!std::filesystem::exists(path)) {
-        std::ostringstream oss;
-        oss << "the file " << std::quoted(path.string()) << " does not exist";
-        throw std::runtime_error{oss.str()};
+mat4 to_mat4(const aiMatrix4x4 &m) noexcept {
+    // Assimp matrices are row major
+    return { vec4 { m.a1, m.b1, m.c1, m.d1 }, vec4 { m.a2, m.b2, m.c2, m.d2 },
+             vec4 { m.a3, m.b3, m.c3, m.d3 }, vec4 { m.a4, m.b4, m.c4, m.d4 } };
+}
+
+void add_nodes(SceneGraph &graph, const aiNode &node, std::uint32_t parent) {
+    const std::vector<std::uint32_t> meshes(node.mMeshes, node.mMeshes + node.mNumMeshes);
+    const std::uint32_t index { graph.addNode(parent, to_mat4(node.mTransformation), meshes) };
+    for (auto i = 0u; i < node.mNumChildren; ++i) {
+        add_nodes(graph, *node.mChildren[i], index);
     }
+}
 
-    aiPropertyStore *props = aiCreatePropertyStore();
-    if (props == nullptr) {
-        throw std::runtime_error{aiGetErrorString()};
+std::vector<BoundingBox> get_bounding_boxes(const std::vector<MeshView> &meshes) {
+    std::vector<BoundingBox> boxes;
+    for (const MeshView &mesh : meshes) {
+        boxes.push_back(mesh.boundingBox);
     }
+    return boxes;
+}
 
-    aiSetImportPropertyInteger(props, AI_CONFIG_PP_PTV_NORMALIZE, 1);
-    const aiScene *scene{aiImportFileExWithProperties(path.string().c_str(),
-                                                      aiProcess_Triangulate |
-                                                      aiProcess_GenSmoothNormals |
-                                                      aiProcess_Triangulate |
-                                                      aiProcess_JoinIdenticalVertices | aiProcess_PreTransformVertices,
-                                                      nullptr, props)};
+/**
+ * @brief Keeps the node hierarchy of a scene, scaled into [-1, 1] as aiProcess_PreTransformVertices would.
+ */
+std::shared_ptr<SceneGraph> load_scene_graph(const aiScene &scene, const std::vector<MeshView> &meshes) {
+    const auto graph { std::make_shared<SceneGraph>() };
+    add_nodes(*graph, *scene.mRootNode, SceneGraph::none);
+
+    const BoundingBox box { graph->getBoundingBox(get_bounding_boxes(meshes)) };
+    const vec3 size { box.getSize() };
+    const float extent { std::max({ size.x, size.y, size.z }) };
+    if (extent > 0.0f) {
+        const mat4 normalization { glm::scale(vec3 { 2.0f / extent }) * glm::translate(-box.getCenter()) };
+        graph->setTransform(0, normalization * graph->getTransform(0));
+        graph->update();
+    }
 
-    aiReleasePropertyStore(props);
-    return scene ? scene
-                    : throw std::runtime_error{aiGetErrorString()};
+    std::size_t num_instances { 0 };
+    for (auto i = 0u; i < meshes.size(); ++i) {
+        num_instances += graph->getInstances(i).size();
+    }
+    std::cout << "kept " << graph->size() << " scene nodes drawing " << num_instances
+              << " instances of " << meshes.size() << " meshes" << std::endl;
+    return graph;
 }
 
-void load_meshes(Model& model, const aiScene &scene, QOpenGLShaderProgram &program) {
-    if (scene.mNumMeshes == 0) {
-        throw std::runtime_error{"empty model"};
+/*********************************************************
+ *                   Spatial Index Code                  *
+ *********************************************************/
+vec3 get_position(const MeshView &mesh, std::size_t vertex) noexcept {
+    if (mesh.vertexFormat == VertexFormat::Compact) {
+        return DecodePosition(static_cast<const CompactVertex*>(mesh.vertices)[vertex], mesh.quantization);
     }
+    return static_cast<const Vertex*>(mesh.vertices)[vertex].position;
+}
 
-    std::vector<Mesh> &meshes { model.getMeshes() };
-    meshes = std::vector<Mesh>(scene.mNumMeshes);
-
-    std::cout << "loading " << meshes.size() << " meshes" << std::endl;
+std::uint32_t get_index(const MeshView &mesh, std::size_t index) noexcept {
+    if (mesh.indexType == GL_UNSIGNED_SHORT) {
+        return static_cast<const GLushort*>(mesh.indices)[index];
+    }
+    return static_cast<const GLuint*>(mesh.indices)[index];
+}
 
+/**
+ * @brief A mesh and the transform its triangles are copied into the BVH with.
+ */
+struct mesh_instance {
+    std::size_t mesh;
+    mat4 transform;
+};
+
+/**
+ * @brief Returns each mesh once, or once per node that draws it in the order Pick() expects.
+ */
+std::vector<mesh_instance> get_instances(const std::vector<MeshView> &meshes, const SceneGraph *graph) {
+    std::vector<mesh_instance> instances;
     for (auto i = 0u; i < meshes.size(); ++i) {
-        const aiMesh &ai_mesh{*scene.mMeshes[i]};
-        create_vbo(meshes[i]._vbo, ai_mesh);
-        create_ibo(meshes[i]._ibo, ai_mesh);
-        create_vao(meshes[i]._vao, meshes[i]._vbo, program);
-
-        if (has_material(ai_mesh)) {
-            meshes[i]._materialIndex = ai_mesh.mMaterialIndex;
+        if (graph == nullptr) {
+            instances.push_back({ i, mat4 { 1.0f } });
+            continue;
+        }
+        for (const std::uint32_t node : graph->getInstances(i)) {
+            instances.push_back({ i, graph->getWorldTransform(node) });
         }
     }
+    return instances;
 }
 
-BoundingBox calculate_bounding_box(const aiScene &scene) noexcept {
-    struct Bound {
-        float min;
-        float max;
-    };
-    tvec3<Bound> bounds;  // TODO: simplifiy code
+/**
+ * @brief Copies the positions and triangles of all meshes and builds a BVH over the triangles.
+ * @details With a scene graph, each instance of a mesh is copied with its world transform,
+ *          so the triangles are picked where the nodes were placed when the model was loaded.
+ * @details Quantized positions are decoded as the vertex shaders do.
+ */
+std::shared_ptr<const TriangleBvh> build_triangle_bvh(const std::vector<MeshView> &meshes,
+                                                      const SceneGraph *graph) {
+    const auto start { std::chrono::steady_clock::now() };
+    const std::vector<mesh_instance> instances { get_instances(meshes, graph) };
+
+    std::vector<std::size_t> first_vertices;
+    std::vector<std::uint32_t> first_triangles;
+    std::size_t num_vertices { 0 };
+    std::size_t num_triangles { 0 };
+    for (const mesh_instance &instance : instances) {
+        const MeshView &mesh { meshes[instance.mesh] };
+        first_vertices.push_back(num_vertices);
+        first_triangles.push_back(static_cast<std::uint32_t>(num_triangles));
+        num_vertices += mesh.numVertices;
+        num_triangles += mesh.numIndices / 3;
+    }
+    if (num_vertices > std::numeric_limits<std::uint32_t>::max() ||
+        num_triangles > std::numeric_limits<std::uint32_t>::max()) {
+        throw std::runtime_error { "too many vertices for a BVH" };
+    }
 
-    BoundingBox boundingBox;
-    for (auto i = 0u; i < scene.mNumMeshes; ++i) {
-        const aiMesh &mesh{*scene.mMeshes[i]};
+    std::vector<vec3> positions(num_vertices);
+    std::vector<TriangleBvh::Triangle> triangles(num_triangles);
+    ParallelFor(instances.size(), [&] (std::size_t i) {
+        const MeshView &mesh { meshes[instances[i].mesh] };
+        const mat4 &transform { instances[i].transform };
+        for (std::size_t j = 0; j < mesh.numVertices; ++j) {
+            positions[first_vertices[i] + j] = vec3 { transform * vec4 { get_position(mesh, j), 1.0f } };
+        }
 
-        for (auto vertex_index = 0u; vertex_index < mesh.mNumVertices; ++vertex_index) {
-            for (auto c = 0; c < 3; ++c) {
-                bounds[c].min = std::min(bounds[c].min, mesh.mVertices[vertex_index][c]);
-                bounds[c].max = std::max(bounds[c].max, mesh.mVertices[vertex_index][c]);
-            }
+        const auto base { static_cast<std::uint32_t>(first_vertices[i]) };
+        for (std::size_t j = 0; j < mesh.numIndices / 3; ++j) {
+            triangles[first_triangles[i] + j] = { base + get_index(mesh, 3 * j), base + get_index(mesh, 3 * j + 1),
+                                                  base + get_index(mesh, 3 * j + 2) };
         }
+    });
+
+    const auto bvh { std::make_shared<const TriangleBvh>(std::move(positions), std::move(triangles),
+                                                         std::move(first_triangles)) };
+    const std::chrono::duration<double, std::milli> duration { std::chrono::steady_clock::now() - start };
+    std::cout << "built a BVH with " << bvh->getBvh().getNodes().size() << " nodes over "
+              << num_triangles << " triangles of " << instances.size() << " mesh instances in "
+              << duration.count() << " ms" << std::endl;
+    return bvh;
+}
+
+/*********************************************************
+ *                  Vertex Compression Code              *
+ *********************************************************/
+constexpr float max_position_error { 1e-4f };         // relative to the extent of the mesh
+constexpr float max_normal_error { 0.1f };            // in degrees
+constexpr float max_texcoords_error { 1.0f / 8192 };  // half a texel of a 4K texture
+
+bool is_acceptable(const CompactVertices &compact) noexcept {
+    const vec3 &size { compact.quantization.scale };
+    const float extent { std::max({ size.x, size.y, size.z }) };
+    return compact.error.position <= max_position_error * extent &&
+           compact.error.normal <= max_normal_error &&
+           compact.error.texcoords <= max_texcoords_error;
+}
+
+/**
+ * @brief Quantizes the vertices of all meshes whose error stays within the limits.
+ * @details Meshes exceeding the limits, e.g. because of far tiling texture
+ *          coordinates, keep their float vertices.
+ */
+void compress_vertices(ModelData &data) {
+    std::vector<CompactVertices> compact(data.meshes.size());
+    ParallelFor(data.meshes.size(), [&] (std::size_t i) {
+        const MeshView &mesh { data.meshes[i] };
+        compact[i] = CompressVertices(static_cast<const Vertex*>(mesh.vertices), mesh.numVertices);
+    });
+
+    QuantizationError max_error;
+    std::size_t num_compressed { 0 };
+    for (auto i = 0u; i < data.meshes.size(); ++i) {
+        const QuantizationError &error { compact[i].error };
+        max_error.position = std::max(max_error.position, error.position);
+        max_error.normal = std::max(max_error.normal, error.normal);
+        max_error.texcoords = std::max(max_error.texcoords, error.texcoords);
+
+        if (!is_acceptable(compact[i])) {
+            std::cout << "warning: keeping float vertices for mesh " << i
+                      << " due to its quantization error" << std::endl;
+            continue;
+        }
+
+        MeshView &mesh { data.meshes[i] };
+        mesh.vertices = compact[i].vertices.data();
+        mesh.vertexFormat = VertexFormat::Compact;
+        mesh.quantization = compact[i].quantization;
+        ++num_compressed;
     }
 
-    const vec3 size {
-        bounds.x.max - bounds.x.min,
-        bounds.y.max - bounds.y.min,
-        bounds.z.max - bounds.z.min
-    };
-    const vec3 center {
-        bounds.x.min + (size.x / 2),
-        bounds.y.min + (size.y / 2),
-        bounds.z.min + (size.z / 2)
-    };
-    return BoundingBox { center, size };
+    std::cout << "compressed the vertices of " << num_compressed << "/" << data.meshes.size() << " meshes"
+              << " (max. error: position " << max_error.position << ", normal " << max_error.normal
+              << " deg, texcoords " << max_error.texcoords << ")" << std::endl;
+
+    // the indices and the remaining float vertices still live in the old storage
+    using storage = std::pair<std::shared_ptr<const void>, std::vector<CompactVertices>>;
+    data.storage = std::make_shared<storage>(std::move(data.storage), std::move(compact));
+}
+
+/*********************************************************
+ *                  Index Compression Code               *
+ *********************************************************/
+/**
+ * @brief Switches all meshes with fewer than 65536 vertices to 16-bit indices.
+ */
+void compress_indices(ModelData &data) {
+    constexpr std::size_t max_vertices { std::numeric_limits<GLushort>::max() + std::size_t { 1 } };
+
+    std::vector<std::vector<GLushort>> indices(data.meshes.size());
+    ParallelFor(data.meshes.size(), [&] (std::size_t i) {
+        const MeshView &mesh { data.meshes[i] };
+        if (mesh.indexType == GL_UNSIGNED_INT && mesh.numVertices < max_vertices) {
+            const GLuint *source { static_cast<const GLuint*>(mesh.indices) };
+            indices[i].assign(source, source + mesh.numIndices);  // all indices are < numVertices
+        }
+    });
+
+    for (auto i = 0u; i < data.meshes.size(); ++i) {
+        if (!indices[i].empty()) {
+            data.meshes[i].indices = indices[i].data();
+            data.meshes[i].indexType = GL_UNSIGNED_SHORT;
+        }
+    }
+
+    using storage = std::pair<std::shared_ptr<const void>, std::vector<std::vector<GLushort>>>;
+    data.storage = std::make_shared<storage>(std::move(data.storage), std::move(indices));
 }
 
 /*********************************************************
@@ -196,70 +685,287 @@ vec3 get_color(const aiMaterial &material,
     return {color.r, color.g, color.b};
 }
 
-float get_shininess(const aiMaterial &material) {
-    return 0;  // TODO
+std::string get_name(const aiMaterial &material) {
+    aiString name;
+    material.Get(AI_MATKEY_NAME, name);
+    return name.C_Str();
 }
 
-const std::filesystem::path get_path(const aiMaterial &material, aiTextureType type,
-	                               const std::filesystem::path &base_path) {
-	aiString str;
-	material.GetTexture(type, 0, &str);
-	return { (base_path / str.data).string() };
+float get_shininess(const aiMaterial &material) {
+    return 0;  // TODO
 }
 
-std::shared_ptr<QOpenGLTexture> get_texture(const aiMaterial &material, aiTextureType type,
-	                                        const std::filesystem::path &base_path) {
+std::filesystem::path get_texture_path(const aiMaterial &material, aiTextureType type,
+                                       const std::filesystem::path &base_path) {
     const unsigned int texture_count{material.GetTextureCount(type)};
-    if (texture_count >= 1) {
-        auto texture { LoadTexture(get_path(material, type, base_path)) };
-        if (texture_count > 1) {
-            std::cout << "warning: found more textures than expected" << std::endl;
-        }
-        return texture;
+    if (texture_count == 0) {
+        return {};
+    }
+    if (texture_count > 1) {
+        std::cout << "warning: found more textures than expected" << std::endl;
     }
-    return {};
+
+    aiString str;
+    material.GetTexture(type, 0, &str);
+    return base_path / str.data;
 }
 
-Material load_material(const aiMaterial &material, const std::filesystem::path &base_path) {
+MaterialData load_material(const aiMaterial &material, const std::filesystem::path &base_path) {
     return {
+        .name = get_name(material),
         .diffuse = get_color(material, AI_MATKEY_COLOR_DIFFUSE),
         .ambient = get_color(material, AI_MATKEY_COLOR_AMBIENT),
         .specular = get_color(material, AI_MATKEY_COLOR_SPECULAR),
         .emissive = get_color(material, AI_MATKEY_COLOR_EMISSIVE),
         .shininess = get_shininess(material),
         .textures{
-            .diffuse = get_texture(material, aiTextureType_DIFFUSE, base_path),
-            .ambient = get_texture(material, aiTextureType_AMBIENT, base_path),
-            .specular = get_texture(material, aiTextureType_SPECULAR, base_path),
-            .emissive = get_texture(material, aiTextureType_EMISSIVE, base_path)} };
+            .diffuse = get_texture_path(material, aiTextureType_DIFFUSE, base_path),
+            .ambient = get_texture_path(material, aiTextureType_AMBIENT, base_path),
+            .specular = get_texture_path(material, aiTextureType_SPECULAR, base_path),
+            .emissive = get_texture_path(material, aiTextureType_EMISSIVE, base_path)} };
 }
 
-std::vector<Material> load_materials(const aiScene &scene, const std::filesystem::path &base_path) {
-    std::cout << "loading " << scene.mNumMaterials << " materials" << std::endl;
-    std::vector<Material> materials;
+std::vector<MaterialData> load_materials(const aiScene &scene, const std::filesystem::path &base_path) {
+    std::vector<MaterialData> materials;
     for (auto i = 0u; i < scene.mNumMaterials; ++i) {
         materials.push_back(load_material(*scene.mMaterials[i], base_path));
     }
     return materials;
 }
 
-} // anonymous namespace
+/*********************************************************
+ *                       Texture Code                    *
+ *********************************************************/
+/**
+ * @brief Decodes every texture that the materials refer to on the thread pool.
+ */
+TextureOptions get_texture_options(const ImportOptions &options) noexcept {
+    return { .compress = options.compressTextures, .mipFilter = options.mipFilter };
+}
 
-std::shared_ptr<Model> LoadModel(const std::filesystem::path &path){
-    const auto model { std::make_shared<Model>() };
-    const aiScene &scene { *importScene(path) };
+TextureFilter get_texture_filter(const MaterialData &material, const ImportOptions &options) {
+    const auto filter { options.materialTextureFilters.find(material.name) };
+    return filter != options.materialTextureFilters.end() ? filter->second : options.textureFilter;
+}
+
+void decode_textures(ModelData &data, const ImportOptions &options,
+                     const ProgressCallback &progress) {
+    std::set<std::filesystem::path> paths;
+    for (const MaterialData &material : data.materials) {
+        for (const auto &path : { material.textures.diffuse, material.textures.ambient,
+                                  material.textures.specular, material.textures.emissive }) {
+            if (!path.empty()) {
+                paths.insert(path);
+            }
+        }
+    }
+
+    for (const auto &path : paths) {
+        data.textures.push_back(TextureCache::instance().prefetch(path, get_texture_options(options)));
+    }
+
+    for (auto i = 0u; i < data.textures.size(); ++i) {
+        if (data.textures[i]) {
+            data.textures[i]->wait();
+        }
+        report(progress, LoadStage::LoadingTextures, static_cast<float>(i + 1) / data.textures.size());
+    }
+}
 
+std::shared_ptr<QOpenGLTexture> get_texture(const std::filesystem::path &path,
+                                            const TextureOptions &options) {
+    if (path.empty()) {
+        return {};
+    }
+    return TextureCache::instance().get(path, options);
+}
+
+std::vector<Material> upload_materials(const std::vector<MaterialData> &data,
+                                       const ImportOptions &options) {
+    const TextureOptions texture_options { get_texture_options(options) };
+    std::cout << "loading " << data.size() << " materials" << std::endl;
+    std::vector<Material> materials;
+    for (const MaterialData &material : data) {
+        materials.push_back({
+            .diffuse = material.diffuse,
+            .ambient = material.ambient,
+            .specular = material.specular,
+            .emissive = material.emissive,
+            .shininess = material.shininess,
+            .textures{
+                .diffuse = get_texture(material.textures.diffuse, texture_options),
+                .ambient = get_texture(material.textures.ambient, texture_options),
+                .specular = get_texture(material.textures.specular, texture_options),
+                .emissive = get_texture(material.textures.emissive, texture_options)},
+            .sampler = GetSampler(get_texture_filter(material, options)) });
+    }
+    return materials;
+}
+
+/*********************************************************
+ *                      Import Code                      *
+ *********************************************************/
+ModelData import_model(const std::filesystem::path &path, const ImportOptions &options,
+                       const ProgressCallback &progress) {
+    progress_handler handler { progress };
+    Assimp::Importer importer;
+    importer.SetProgressHandler(&handler);
+    const aiScene &scene { importScene(importer, path, get_import_flags(options)) };
+
+    const auto meshes { std::make_shared<const std::vector<MeshData>>(load_meshes(scene, options, progress)) };
+
+    ModelData data;
+    data.meshes = get_views(*meshes);
+    data.materials = load_materials(scene, path.parent_path());
+    if (options.preTransformVertices) {
+        data.boundingBox = calculate_bounding_box(data.meshes);
+    } else {
+        data.sceneGraph = load_scene_graph(scene, data.meshes);
+        data.boundingBox = data.sceneGraph->getBoundingBox(get_bounding_boxes(data.meshes));
+    }
+    data.storage = meshes;
+    return data;
+}
+
+ModelData load_geometry(const std::filesystem::path &path, const ImportOptions &options,
+                        const ProgressCallback &progress) {
+    if (!std::filesystem::exists(path)) {
+        std::ostringstream oss;
+        oss << "the file " << std::quoted(path.string()) << " does not exist";
+        throw std::runtime_error{oss.str()};
+    }
+
+    if (options.useCache) {
+        std::optional<ModelData> cached { LoadModelCache(path, get_import_flags(options), get_cache_options(options)) };
+        if (cached.has_value()) {
+            std::cout << "loaded " << path << " from cache" << std::endl;
+            report(progress, LoadStage::Parsing, 1.0f);
+            report(progress, LoadStage::PostProcessing, 1.0f);
+            report(progress, LoadStage::BuildingBuffers, 1.0f);
+            return std::move(cached.value());
+        }
+    }
+
+    ModelData data { import_model(path, options, progress) };
+    // cached compressed, so warm starts upload straight from the mapped file
+    if (options.vertexFormat == VertexFormat::Compact) {
+        compress_vertices(data);
+    }
+    compress_indices(data);
+    if (options.useCache) {
+        try {
+            SaveModelCache(path, get_import_flags(options), get_cache_options(options), data);
+        } catch (const std::exception &exception) {
+            std::cout << "warning: could not write model cache: " << exception.what() << std::endl;
+        }
+    }
+    return data;
+}
+
+/**
+ * @brief Runs all CPU side load stages.
+ */
+ModelData load_model_data(const std::filesystem::path &path, const ImportOptions &options,
+                          const ProgressCallback &progress) {
+    ModelData data { load_geometry(path, options, progress) };
+    if (options.buildTriangleBvh) {
+        data.triangles = build_triangle_bvh(data.meshes, data.sceneGraph.get());
+    }
+    decode_textures(data, options, progress);
+    return data;
+}
+
+/**
+ * @brief Runs the OpenGL load stage.
+ */
+std::shared_ptr<Model> upload_model(const ModelData &data, const ImportOptions &options,
+                                    const ProgressCallback &progress) {
+    const auto model { std::make_shared<Model>() };
     model->setProgram(LoadProgram({ "./assets/shaders/main.vs", "./assets/shaders/main.fs" }));
-    load_meshes(*model, scene, *model->getProgram());
-    model->setMaterials(load_materials(scene, path.parent_path()));
-    model->setBoundingBox(calculate_bounding_box(scene));
+    model->setInstancedProgram(LoadProgram({ "./assets/shaders/main_instanced.vs", "./assets/shaders/main.fs" }));
+    upload_meshes(*model, data.meshes, *model->getProgram(), options, progress);
+    if (options.shareBuffers && options.drawIndirect && !data.sceneGraph && IsIndirectDrawingSupported()) {
+        model->setIndirectProgram(LoadProgram({ "./assets/shaders/main_indirect.vs",
+                                                "./assets/shaders/main_indirect.fs" }));
+    }
+    model->setMaterials(upload_materials(data.materials, options));
+    model->setBoundingBox(data.boundingBox);
+    model->setTriangleBvh(data.triangles);
+    model->setSceneGraph(data.sceneGraph);
+    return model;
+}
+
+/**
+ * @brief Makes sure that @p progress is never called concurrently.
+ */
+ProgressCallback serialize(ProgressCallback progress) {
+    if (!progress) {
+        return {};
+    }
+
+    const auto mutex { std::make_shared<std::mutex>() };
+    return [mutex, progress] (LoadStage stage, float value) {
+        std::lock_guard<std::mutex> lock { *mutex };
+        progress(stage, value);
+    };
+}
+
+} // anonymous namespace
+
+/* ------------------------------------ PendingModel ------------------------------------ */
+
+PendingModel::PendingModel(std::future<ModelData> data, const ImportOptions &options, ProgressCallback progress)
+    : _data { std::move(data) },
+      _options { options },
+      _progress { std::move(progress) } {
+}
+
+bool PendingModel::isReady() const {
+    return _data.valid() &&
+           _data.wait_for(std::chrono::seconds::zero()) == std::future_status::ready;
+}
+
+std::shared_ptr<Model> PendingModel::get() {
+    if (!_data.valid()) {
+        throw std::logic_error { "the model has already been retrieved" };
+    }
+    const ModelData data { _data.get() };
+    return upload_model(data, _options, _progress);
+}
+
+/* ------------------------------------ Loading ------------------------------------ */
+
+PendingModel LoadModelAsync(const std::filesystem::path &path, ProgressCallback progress,
+                            const ImportOptions &options) {
+    progress = serialize(std::move(progress));
+    std::future<ModelData> data {
+        std::async(std::launch::async, [path, options, progress] () {
+            return load_model_data(path, options, progress);
+        })
+    };
+    return { std::move(data), options, progress };
+}
+
+std::shared_ptr<Model> LoadModel(const std::filesystem::path &path, const ImportOptions &options) {
+    if (options.reportMemoryUsage && !ResetPeakMemoryUsage()) {
+        std::cout << "warning: could not reset peak RSS, reporting the process peak" << std::endl;
+    }
+
+    std::shared_ptr<Model> model;
+    {
+        const ModelData data { load_model_data(path, options, {}) };
+        model = upload_model(data, options, {});
+    }
+
+    if (options.reportMemoryUsage) {
+        std::cout << "peak RSS while loading " << path << ": "
+                  << GetPeakMemoryUsage() / (1024 * 1024) << " MiB" << std::endl;
+    }
     return model;
 }
 
 std::shared_ptr<QOpenGLTexture> LoadTexture(const std::filesystem::path &path) {
-	QImage image { path.string().c_str() };
-	std::cout << "loading " << path << std::endl;
-	return std::make_shared<QOpenGLTexture>(image);
+	return TextureCache::instance().get(path);
 }
 
 } // namespace bgl
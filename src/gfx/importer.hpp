@@ -6,22 +6,151 @@
 #ifndef GFX_IMPORTER_HPP_
 #define GFX_IMPORTER_HPP_
 
-#include <memory>
 #include <filesystem>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "gl.hpp"
+#include "mesh.hpp"
+#include "model.hpp"
+#include "bounding_box.hpp"
+#include "bvh.hpp"
+#include "scene_graph.hpp"
+#include "texture_cache.hpp"
+
+class QOpenGLTexture;
 
 
 namespace bgl {
 
+/**
+ * @brief Post-processed geometry of a single mesh as produced by Assimp.
+ */
+struct MeshData {
+    std::vector<Vertex> vertices;
+    std::vector<GLuint> indices;  // triangle list
+    std::optional<unsigned int> materialIndex;  // index to an Assimp material
+};
+
+/**
+ * @brief Non-owning view of a mesh's vertices and indices, ready to be uploaded.
+ */
+struct MeshView {
+    const void *vertices;  // Vertex or CompactVertex, see @p vertexFormat
+    std::size_t numVertices;
+    const void *indices;   // GLuint or GLushort, see @p indexType
+    std::size_t numIndices;
+    std::optional<unsigned int> materialIndex;
+    VertexFormat vertexFormat { VertexFormat::Float };
+    VertexQuantization quantization;
+    GLenum indexType { GL_UNSIGNED_INT };
+    BoundingBox boundingBox { 0.0f };  // of the positions
+};
+
+/**
+ * @brief A material that refers to its textures by path.
+ */
+struct MaterialData {
+    std::string name;
+    vec3 diffuse;
+    vec3 ambient;
+    vec3 specular;
+    vec3 emissive;
+    float shininess;
+
+    struct {
+        std::filesystem::path diffuse;
+        std::filesystem::path ambient;
+        std::filesystem::path specular;
+        std::filesystem::path emissive;
+    } textures;
+};
+
+/**
+ * @brief CPU-side result of a model import (see LoadModelCache()).
+ */
+struct ModelData {
+    std::vector<MeshView> meshes;
+    std::vector<MaterialData> materials;
+    BoundingBox boundingBox;
+    std::shared_ptr<const void> storage;  // owns the memory @p meshes point into
+    std::shared_ptr<const TriangleBvh> triangles;  // if ImportOptions::buildTriangleBvh is set
+    std::shared_ptr<SceneGraph> sceneGraph;        // unless ImportOptions::preTransformVertices is set
+    std::vector<PendingTexture> textures;          // keeps the decoded images alive until the upload
+};
+
+/**
+ * @brief The stages of a model load in the order they are reported.
+ */
+enum class LoadStage {
+    Parsing,
+    PostProcessing,
+    BuildingBuffers,
+    LoadingTextures,
+    Uploading
+};
+
+/**
+ * @brief Receives the current load stage and the progress within it [0, 1].
+ * @note Called from the loading threads, but never concurrently.
+ */
+using ProgressCallback = std::function<void(LoadStage stage, float progress)>;
+
+/**
+ * @brief A non-copyable, but moveable handle of a model that is loaded in the background.
+ */
+class PendingModel {
+ public:
+	PendingModel(std::future<ModelData> data, const ImportOptions &options, ProgressCallback progress);
+	PendingModel(PendingModel&&) = default;
+	PendingModel& operator=(PendingModel&&) = default;
+
+	PendingModel(const PendingModel&) = delete;
+	PendingModel& operator=(const PendingModel&) = delete;
+
+	virtual ~PendingModel() noexcept = default;
+
+	/**
+	 * @brief Checks whether the CPU side stages are done and get() will not block.
+	 */
+	bool isReady() const;
+
+	/**
+	 * @brief Uploads the loaded model or rethrows the error that stopped the load.
+	 * @note The OpenGL context has to be current. Can only be called once.
+	 */
+	std::shared_ptr<Model> get();
+
+ private:
+	std::future<ModelData> _data;
+	ImportOptions _options;
+	ProgressCallback _progress;
+};
+
 /**
  * @brief Loads and creates an OpenGL texture from an image file.
+ * @details Textures are shared through the TextureCache.
  */
 std::shared_ptr<QOpenGLTexture> LoadTexture(const std::filesystem::path &path);
 
 /**
  * @brief Loads a 3D model from a given path.
  */
-std::shared_ptr<Model> LoadModel(const std::filesystem::path &path);
+std::shared_ptr<Model> LoadModel(const std::filesystem::path &path, const ImportOptions &options);
+
+/**
+ * @brief Starts to load a 3D model in the background.
+ * @details Parsing, post-processing, building buffers and decoding textures
+ *          happen on other threads. Only the upload in PendingModel::get()
+ *          needs the OpenGL context.
+ */
+PendingModel LoadModelAsync(const std::filesystem::path &path, ProgressCallback progress = {},
+                            const ImportOptions &options = {});
 
-}
+}  // namespace bgl
 
 #endif  // GFX_IMPORTER_HPP_
@@ -0,0 +1,189 @@
+#include <algorithm>
+#include <functional>  // std::less
+#include <numeric>     // std::iota()
+#include <optional>
+#include <stdexcept>
+#include <tuple>
+
+#include "indirect_draw.hpp"
+#include "mesh.hpp"
+#include "state_tracker.hpp"
+#include "stream_buffer.hpp"
+#include "uniform_buffer.hpp"
+
+#include <QOpenGLTexture>  // NOLINT
+
+
+namespace bgl {
+
+namespace {
+
+QOpenGLTexture* get_texture(const DrawCommand &command) noexcept {
+    return command.material ? command.material->textures.diffuse.get() : nullptr;
+}
+
+const Sampler* get_sampler(const DrawCommand &command) noexcept {
+    return command.material && command.material->textures.diffuse ? command.material->sampler.get() : nullptr;
+}
+
+/**
+ * @brief The state that has to be equal within one glMultiDrawElementsIndirect().
+ */
+auto get_batch_key(const DrawCommand &command) noexcept {
+    return std::make_tuple(static_cast<const void*>(command.mesh->_arena.get()), command.mesh->_indexType,
+                           static_cast<const void*>(get_texture(command)),
+                           static_cast<const void*>(get_sampler(command)));
+}
+
+bool is_before(const DrawCommand &a, const DrawCommand &b) noexcept {
+    const auto [arena_a, type_a, texture_a, sampler_a] { get_batch_key(a) };
+    const auto [arena_b, type_b, texture_b, sampler_b] { get_batch_key(b) };
+    const std::less<const void*> less;
+    if (arena_a != arena_b) {
+        return less(arena_a, arena_b);
+    }
+    if (type_a != type_b) {
+        return type_a < type_b;
+    }
+    if (texture_a != texture_b) {
+        return less(texture_a, texture_b);
+    }
+    return less(sampler_a, sampler_b);
+}
+
+GLuint create_buffer(GLenum target, const void *data, std::size_t size) {
+    GLuint buffer { 0 };
+    glGenBuffers(1, &buffer);
+    glBindBuffer(target, buffer);
+    glBufferData(target, size, data, GL_STATIC_DRAW);
+    glBindBuffer(target, 0);
+    return buffer;
+}
+
+}  // anonymous namespace
+
+bool IsIndirectDrawingSupported() {
+    const bool multi_draw_indirect { GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect };
+    const bool storage_buffers { GLEW_VERSION_4_3 || GLEW_ARB_shader_storage_buffer_object };
+    return multi_draw_indirect && storage_buffers && GLEW_ARB_shader_draw_parameters;
+}
+
+IndirectDrawList::IndirectDrawList(const std::vector<DrawCommand> &commands,
+                                   const std::vector<Material> &materials) {
+    _drawIndices.resize(commands.size());
+    std::iota(_drawIndices.begin(), _drawIndices.end(), std::size_t { 0 });
+    std::stable_sort(_drawIndices.begin(), _drawIndices.end(),
+                     [&] (std::size_t a, std::size_t b) { return is_before(commands[a], commands[b]); });
+
+    std::vector<IndirectDrawData> draws;
+    for (const std::size_t draw_index : _drawIndices) {
+        const DrawCommand &command { commands[draw_index] };
+        const Mesh &mesh { *command.mesh };
+        if (!mesh._arena) {
+            throw std::invalid_argument { "indirect drawing requires meshes in a mesh arena" };
+        }
+
+        const auto index { static_cast<GLuint>(draws.size()) };
+        _commands.push_back({
+            .count = static_cast<GLuint>(mesh._numIndices),
+            .instanceCount = 1,
+            .firstIndex = static_cast<GLuint>(mesh._firstIndex / GetIndexSize(mesh._indexType)),
+            .baseVertex = mesh._baseVertex,
+            .baseInstance = index });
+
+        // meshes without a material use the default material behind the others
+        const std::size_t material { command.material ? command.material - materials.data() : materials.size() };
+        draws.push_back({
+            .offset = mesh._quantization.offset,
+            .material = static_cast<GLuint>(material),
+            .scale = mesh._quantization.scale,
+            .octahedral = mesh._vertexFormat == VertexFormat::Compact,
+            .texcoordOffset = mesh._quantization.texcoordOffset,
+            .texcoordScale = mesh._quantization.texcoordScale });
+
+        if (_batches.empty() || get_batch_key(command) != get_batch_key(commands[_drawIndices[index - 1]])) {
+            _batches.push_back({
+                .arena = mesh._arena.get(),
+                .indexType = mesh._indexType,
+                .texture = get_texture(command),
+                .sampler = get_sampler(command),
+                .first = index,
+                .count = 0 });
+        }
+        ++_batches.back().count;
+    }
+
+    std::vector<MaterialBlock> blocks;
+    for (const Material &material : materials) {
+        blocks.push_back(GetMaterialBlock(material));
+    }
+    blocks.push_back({ .ambient = vec3 { 1.0f }, .shininess = 0.0f, .diffuse = vec3 { 1.0f },
+                       .isTextured = GL_FALSE, .specular = vec3 { 0.0f }, .padding = 0.0f });
+
+    _numDraws = draws.size();
+    _commandBuffer = create_buffer(GL_DRAW_INDIRECT_BUFFER, _commands.data(),
+                                   _commands.size() * sizeof(DrawElementsIndirectCommand));
+    _drawBuffer = create_buffer(GL_SHADER_STORAGE_BUFFER, draws.data(), draws.size() * sizeof(IndirectDrawData));
+    _materialBuffer = create_buffer(GL_SHADER_STORAGE_BUFFER, blocks.data(), blocks.size() * sizeof(MaterialBlock));
+}
+
+IndirectDrawList::~IndirectDrawList() noexcept {
+    const GLuint buffers[] { _commandBuffer, _drawBuffer, _materialBuffer };
+    glDeleteBuffers(3, buffers);
+}
+
+void IndirectDrawList::render(const std::vector<std::uint8_t> &visible, GLuint textureUnit) {
+    GLuint command_buffer { _commandBuffer };
+    std::size_t command_offset { 0 };
+    if (!visible.empty()) {
+        // culled draws keep their command with an instance count of 0
+        _culledCommands = _commands;
+        for (auto i = 0u; i < _culledCommands.size(); ++i) {
+            _culledCommands[i].instanceCount = visible.at(_drawIndices[i]) ? 1 : 0;
+        }
+
+        const std::optional<StreamAllocation> allocation {
+            StreamBuffer::instance().write(_culledCommands.data(),
+                                           _culledCommands.size() * sizeof(DrawElementsIndirectCommand),
+                                           alignof(DrawElementsIndirectCommand)) };
+        if (allocation.has_value()) {  // otherwise all draws are submitted
+            command_buffer = allocation->buffer;
+            command_offset = allocation->offset;
+        }
+    }
+
+    StateTracker &tracker { StateTracker::instance() };
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, static_cast<GLuint>(StorageBlock::Draws), _drawBuffer);
+    glBindBufferBase(GL_SHADER_STORAGE_BUFFER, static_cast<GLuint>(StorageBlock::Materials), _materialBuffer);
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+
+    for (const Batch &batch : _batches) {
+        const auto first { _drawIndices.begin() + batch.first };
+        if (std::none_of(first, first + batch.count,
+                         [&] (std::size_t draw_index) { return visible.empty() || visible[draw_index]; })) {
+            continue;  // culled completely
+        }
+
+        tracker.bindVertexArray(batch.arena->_vao);
+        if (batch.texture) {
+            tracker.bindTexture(textureUnit, *batch.texture, batch.sampler);
+        }
+        const std::size_t offset { command_offset + batch.first * sizeof(DrawElementsIndirectCommand) };
+        glMultiDrawElementsIndirect(GL_TRIANGLES, batch.indexType, reinterpret_cast<const void*>(offset),
+                                    batch.count, 0);
+        tracker.countDrawCall();
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, 0);
+    tracker.releaseVertexArray();
+}
+
+std::size_t IndirectDrawList::getNumDraws() const noexcept {
+    return _numDraws;
+}
+
+std::size_t IndirectDrawList::getNumBatches() const noexcept {
+    return _batches.size();
+}
+
+}  // namespace bgl
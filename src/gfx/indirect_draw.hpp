@@ -0,0 +1,117 @@
+/**
+ * @file indirect_draw.hpp
+ * @brief Submission of whole models with glMultiDrawElementsIndirect().
+ */
+#ifndef GFX_INDIRECT_DRAW_HPP_
+#define GFX_INDIRECT_DRAW_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gl.hpp"
+#include "math.hpp"
+#include "draw_list.hpp"
+#include "material.hpp"
+
+class QOpenGLTexture;
+
+
+namespace bgl {
+
+class Sampler;
+struct MeshArena;
+
+/**
+ * @brief Binding points of the shader storage blocks of the indirect programs.
+ */
+enum class StorageBlock : GLuint {
+    Draws = 0,     // "DrawBuffer", one IndirectDrawData per draw
+    Materials = 1  // "MaterialBuffer", one MaterialBlock per material
+};
+
+/**
+ * @brief One draw of glMultiDrawElementsIndirect() as OpenGL expects it.
+ */
+struct DrawElementsIndirectCommand {
+	GLuint count;
+	GLuint instanceCount;
+	GLuint firstIndex;    // in indices, not bytes
+	GLint baseVertex;
+	GLuint baseInstance;  // the index of the IndirectDrawData of the draw
+};
+
+/**
+ * @brief Mirror of the std430 layout of "DrawData" in main_indirect.vs.
+ */
+struct IndirectDrawData {
+	vec3 offset;        // of the quantized positions
+	GLuint material;    // index into the material buffer
+	vec3 scale;
+	GLuint octahedral;  // normals are octahedral encoded
+	vec2 texcoordOffset;  // of the quantized texture coordinates
+	vec2 texcoordScale;
+};
+
+static_assert(sizeof(DrawElementsIndirectCommand) == 20, "unexpected indirect command size");
+static_assert(sizeof(IndirectDrawData) == 48, "IndirectDrawData does not match its std430 layout");
+
+/**
+ * @brief Returns whether multi-draw indirect, shader storage buffers and gl_BaseInstanceARB are available.
+ */
+bool IsIndirectDrawingSupported();
+
+/**
+ * @brief The draws of a model in GPU buffers, submitted with one
+ *        glMultiDrawElementsIndirect() per batch.
+ * @details Draws are batched by mesh arena, index type and diffuse texture,
+ *          the only state that cannot vary within a multi-draw. Materials and
+ *          vertex quantization are looked up per draw in the shaders.
+ * @note All meshes must be part of a MeshArena.
+ */
+class IndirectDrawList final {
+ public:
+	/**
+	 * @param commands The draws, their materials have to be elements of @p materials.
+	 */
+	IndirectDrawList(const std::vector<DrawCommand> &commands, const std::vector<Material> &materials);
+
+	IndirectDrawList(const IndirectDrawList&) = delete;
+	IndirectDrawList& operator=(const IndirectDrawList&) = delete;
+
+	~IndirectDrawList() noexcept;
+
+	/**
+	 * @brief Draws all batches with the bound program.
+	 * @param visible Whether each draw command, in the order passed to the
+	 *                constructor, is visible. All are drawn if it is empty.
+	 * @param textureUnit The unit the "materialTexture" sampler of the program reads.
+	 */
+	void render(const std::vector<std::uint8_t> &visible = {}, GLuint textureUnit = 0);
+
+	std::size_t getNumDraws() const noexcept;
+	std::size_t getNumBatches() const noexcept;
+
+ private:
+	struct Batch {
+		MeshArena *arena;
+		GLenum indexType;
+		QOpenGLTexture *texture;  // nullptr for untextured draws
+		const Sampler *sampler;
+		std::size_t first;        // index of the first command
+		GLsizei count;
+	};
+
+	std::vector<DrawElementsIndirectCommand> _commands;
+	std::vector<DrawElementsIndirectCommand> _culledCommands;  // reused between frames
+	std::vector<std::size_t> _drawIndices;  // the index of the draw command of each indirect command
+	std::vector<Batch> _batches;
+	std::size_t _numDraws { 0 };
+	GLuint _commandBuffer { 0 };
+	GLuint _drawBuffer { 0 };
+	GLuint _materialBuffer { 0 };
+};
+
+}  // namespace bgl
+
+#endif  // GFX_INDIRECT_DRAW_HPP_
@@ -0,0 +1,90 @@
+#include <fcntl.h>     // open()
+#include <sys/mman.h>  // mmap(), munmap(), madvise()
+#include <sys/stat.h>  // fstat()
+#include <unistd.h>    // close()
+
+#include <cerrno>
+#include <cstring>     // std::strerror()
+#include <stdexcept>
+#include <string>
+#include <utility>     // std::exchange()
+
+#include "mapped_file.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+[[noreturn]] void throw_system_error(const std::string &what, const std::filesystem::path &path) {
+    throw std::runtime_error { what + " " + path.string() + ": " + std::strerror(errno) };
+}
+
+}  // anonymous namespace
+
+MappedFile::MappedFile(const std::filesystem::path &path) {
+    const int fd { ::open(path.c_str(), O_RDONLY | O_CLOEXEC) };
+    if (fd < 0) {
+        throw_system_error("could not open", path);
+    }
+
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        ::close(fd);
+        throw_system_error("could not stat", path);
+    }
+
+    _size = static_cast<std::size_t>(status.st_size);
+    if (_size > 0) {
+        _data = ::mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+    }
+    ::close(fd);  // the mapping keeps its own reference to the file
+
+    if (_data == MAP_FAILED) {
+        _data = nullptr;
+        throw_system_error("could not map", path);
+    }
+}
+
+MappedFile::MappedFile(MappedFile &&rhs) noexcept
+    : _data { std::exchange(rhs._data, nullptr) },
+      _size { std::exchange(rhs._size, 0) } {
+}
+
+MappedFile& MappedFile::operator=(MappedFile &&rhs) noexcept {
+    if (this != &rhs) {
+        unmap();
+        _data = std::exchange(rhs._data, nullptr);
+        _size = std::exchange(rhs._size, 0);
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() noexcept {
+    unmap();
+}
+
+const std::byte* MappedFile::data() const noexcept {
+    return static_cast<const std::byte*>(_data);
+}
+
+std::size_t MappedFile::size() const noexcept {
+    return _size;
+}
+
+void MappedFile::adviseSequential() const noexcept {
+    if (_data != nullptr) {
+        ::madvise(_data, _size, MADV_SEQUENTIAL);
+        ::madvise(_data, _size, MADV_WILLNEED);
+    }
+}
+
+void MappedFile::unmap() noexcept {
+    if (_data != nullptr) {
+        ::munmap(_data, _size);
+        _data = nullptr;
+        _size = 0;
+    }
+}
+
+}  // namespace bgl
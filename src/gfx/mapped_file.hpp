@@ -0,0 +1,45 @@
+/**
+ * @file mapped_file.hpp
+ * @brief Read-only memory mapped files.
+ */
+#ifndef GFX_MAPPED_FILE_HPP_
+#define GFX_MAPPED_FILE_HPP_
+
+#include <cstddef>
+#include <filesystem>
+
+
+namespace bgl {
+
+/**
+ * @brief A non-copyable, but moveable read-only memory mapping of a whole file.
+ */
+class MappedFile final {
+ public:
+	explicit MappedFile(const std::filesystem::path &path);
+	MappedFile(MappedFile &&rhs) noexcept;
+	MappedFile& operator=(MappedFile &&rhs) noexcept;
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile() noexcept;
+
+	const std::byte* data() const noexcept;
+	std::size_t size() const noexcept;
+
+	/**
+	 * @brief Tells the kernel that the mapping will be read front to back once.
+	 */
+	void adviseSequential() const noexcept;
+
+ private:
+	void unmap() noexcept;
+
+	void *_data { nullptr };
+	std::size_t _size { 0 };
+};
+
+}  // namespace bgl
+
+#endif  // GFX_MAPPED_FILE_HPP_
@@ -9,6 +9,8 @@ class QOpenGLTexture;
 
 namespace bgl  {
 
+class Sampler;
+
 using namespace glm;  // NOLINT
 
 struct Material {
@@ -24,6 +26,8 @@ struct Material {
         std::shared_ptr<QOpenGLTexture> specular;
         std::shared_ptr<QOpenGLTexture> emissive;
     } textures;
+
+    std::shared_ptr<Sampler> sampler;  // filtering of all textures, may be shared with other materials
 };
 
 }  // namespace bgl
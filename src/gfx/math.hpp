@@ -22,6 +22,7 @@ using ivec2 = glm::tvec2<GLint>;
 using uvec2 = glm::tvec2<GLuint>;
 using vec2 = glm::tvec2<GLfloat>;
 using vec3 = glm::tvec3<GLfloat>;
+using vec4 = glm::tvec4<GLfloat>;
 template<typename T> using tvec2 = glm::tvec2<T>;
 template<typename T> using tvec3 = glm::tvec3<T>;
 
@@ -0,0 +1,35 @@
+#include <sys/resource.h>  // getrusage()
+
+#include <fstream>
+#include <sstream>
+#include <string>
+
+#include "memory.hpp"
+
+
+namespace bgl {
+
+std::size_t GetPeakMemoryUsage() {
+    // VmHWM follows ResetPeakMemoryUsage(), ru_maxrss does not
+    std::ifstream status { "/proc/self/status" };
+    for (std::string line; std::getline(status, line);) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            std::istringstream iss { line.substr(6) };
+            std::size_t kilobytes { 0 };
+            iss >> kilobytes;
+            return kilobytes * 1024;
+        }
+    }
+
+    rusage usage {};
+    getrusage(RUSAGE_SELF, &usage);
+    return static_cast<std::size_t>(usage.ru_maxrss) * 1024;
+}
+
+bool ResetPeakMemoryUsage() noexcept {
+    // see proc(5): writing 5 to clear_refs resets VmHWM
+    std::ofstream clear_refs { "/proc/self/clear_refs" };
+    return static_cast<bool>(clear_refs << "5" << std::flush);
+}
+
+}  // namespace bgl
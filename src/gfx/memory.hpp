@@ -0,0 +1,26 @@
+/**
+ * @file memory.hpp
+ * @brief Process memory statistics.
+ */
+#ifndef GFX_MEMORY_HPP_
+#define GFX_MEMORY_HPP_
+
+#include <cstddef>
+
+
+namespace bgl {
+
+/**
+ * @brief Returns the peak resident set size of the process in bytes.
+ */
+std::size_t GetPeakMemoryUsage();
+
+/**
+ * @brief Resets the peak resident set size to the current one.
+ * @return false if the kernel does not support resetting it.
+ */
+bool ResetPeakMemoryUsage() noexcept;
+
+}  // namespace bgl
+
+#endif  // GFX_MEMORY_HPP_
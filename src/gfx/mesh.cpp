@@ -1,11 +1,28 @@
 #include <iostream>
 #include <stdexcept>
+#include <utility>  // std::move()
 
 #include "mesh.hpp"
+#include "gl_debug.hpp"
+#include "state_tracker.hpp"
 
 
 namespace bgl {
 
+MeshArena::MeshArena()
+    : _vbo { QOpenGLBuffer::VertexBuffer },
+      _ibo { QOpenGLBuffer::IndexBuffer } {
+    if (!_vbo.create()) {
+        throw std::runtime_error { "could not create VBO" };
+    }
+    if (!_ibo.create()) {
+        throw std::runtime_error { "could not create IBO" };
+    }
+    if (!_vao.create() || !_instancedVao.create()) {
+        throw std::runtime_error { "could not create VAO" };
+    }
+}
+
 Mesh::Mesh()
     : _vbo { QOpenGLBuffer::VertexBuffer },
       _ibo { QOpenGLBuffer::IndexBuffer } {
@@ -15,23 +32,58 @@ Mesh::Mesh()
     if (!_ibo.create()) {
         throw std::runtime_error { "could not create IBO" };
     }
-    if (!_vao.create()) {
+    if (!_vao.create() || !_instancedVao.create()) {
         throw std::runtime_error { "could not create VAO" };
     }
 }
 
+Mesh::Mesh(std::shared_ptr<MeshArena> arena)
+    : _vbo { QOpenGLBuffer::VertexBuffer },
+      _ibo { QOpenGLBuffer::IndexBuffer },
+      _arena { std::move(arena) } {
+    if (!_arena) {
+        throw std::invalid_argument { "missing mesh arena" };
+    }
+    _vertexFormat = _arena->_vertexFormat;
+}
+
 void Mesh::render(GLenum mode, GLuint count) {
     bind();
-    glDrawElements(mode, count, GL_UNSIGNED_INT, nullptr);
-    if (glGetError() != GL_NO_ERROR) {
-        throw std::runtime_error { "glDrawElements() failed" };
-    }
+    glDrawElements(mode, count, _indexType, nullptr);
+    CheckGLError("glDrawElements()");
     release();
 }
 
 void Mesh::render(GLenum mode) {
+    if (_arena) {
+        StateTracker::instance().bindVertexArray(_arena->_vao);  // stays bound for the next mesh
+        glDrawElementsBaseVertex(mode, _numIndices, _indexType, reinterpret_cast<const void*>(_firstIndex),
+                                 _baseVertex);
+        CheckGLError("glDrawElementsBaseVertex()");
+        return;
+    }
+
     _ibo.bind();  // for each @p _ibo.size()
-    render(mode, static_cast<GLuint>(_ibo.size()) / sizeof(GLuint));
+    render(mode, static_cast<GLuint>(_ibo.size() / GetIndexSize(_indexType)));
+}
+
+void Mesh::renderInstanced(GLenum mode, GLsizei instances) {
+    StateTracker::instance().bindVertexArray(getInstancedVertexArray());
+    if (_arena) {
+        glDrawElementsInstancedBaseVertex(mode, _numIndices, _indexType, reinterpret_cast<const void*>(_firstIndex),
+                                          instances, _baseVertex);
+        CheckGLError("glDrawElementsInstancedBaseVertex()");
+        return;
+    }
+
+    _ibo.bind();  // for each @p _ibo.size()
+    const auto count { static_cast<GLsizei>(_ibo.size() / GetIndexSize(_indexType)) };
+    glDrawElementsInstanced(mode, count, _indexType, nullptr, instances);
+    CheckGLError("glDrawElementsInstanced()");
+}
+
+QOpenGLVertexArrayObject& Mesh::getInstancedVertexArray() noexcept {
+    return _arena ? _arena->_instancedVao : _instancedVao;
 }
 
 void Mesh::bind() {
@@ -46,4 +98,38 @@ void Mesh::release() {
     _ibo.release();
 }
 
+namespace {
+
+constexpr GLuint instance_attribute_location { 3 };  // of the mat4 of main_instanced.vs
+constexpr GLuint instance_binding { instance_attribute_location };  // 0 to 2 are used by the vertex attributes
+
+}  // anonymous namespace
+
+void SetupInstanceAttributes() {
+    for (GLuint column = 0; column < 4; ++column) {
+        const GLuint location { instance_attribute_location + column };
+        glEnableVertexAttribArray(location);
+        glVertexAttribFormat(location, 4, GL_FLOAT, GL_FALSE, static_cast<GLuint>(column * sizeof(vec4)));
+        glVertexAttribBinding(location, instance_binding);
+    }
+    glVertexBindingDivisor(instance_binding, 1);
+}
+
+void BindInstanceBuffer(GLuint buffer, std::size_t offset) {
+    glBindVertexBuffer(instance_binding, buffer, static_cast<GLintptr>(offset), sizeof(mat4));
+}
+
+std::size_t GetIndexSize(GLenum type) {
+    switch (type) {
+        case GL_UNSIGNED_INT:
+            return sizeof(GLuint);
+        case GL_UNSIGNED_SHORT:
+            return sizeof(GLushort);
+        case GL_UNSIGNED_BYTE:
+            return sizeof(GLubyte);
+        default:
+            throw std::invalid_argument { "unsupported index type" };
+    }
+}
+
 }  // namespace bgl
@@ -1,9 +1,13 @@
 #ifndef GFX_MESH_HPP_
 #define GFX_MESH_HPP_
 
+#include <cstddef>
+#include <memory>
 #include <optional>
 
 #include "gl.hpp"
+#include "bounding_box.hpp"
+#include "vertex_format.hpp"
 
 #include <QOpenGLBuffer>             // NOLINT
 #include <QOpenGLVertexArrayObject>  // NOLINT
@@ -12,12 +16,20 @@
 namespace bgl {
 
 /**
- * @brief OpenGL VBO vertex format.
+ * @brief One vertex and one index buffer shared by all meshes of a model with the same vertex format.
+ * @details The VAO captures the index buffer, so binding it is all a draw needs.
  */
-struct Vertex {
-    vec3 position;
-    vec3 normal;
-    vec2 texcoords;
+struct MeshArena {
+	MeshArena();
+
+	MeshArena(const MeshArena&) = delete;
+	MeshArena& operator=(const MeshArena&) = delete;
+
+	QOpenGLBuffer _vbo;
+	QOpenGLBuffer _ibo;
+	QOpenGLVertexArrayObject _vao;
+	QOpenGLVertexArrayObject _instancedVao;  // see SetupInstanceAttributes()
+	VertexFormat _vertexFormat { VertexFormat::Float };
 };
 
 /**
@@ -26,6 +38,11 @@ struct Vertex {
  */
 struct Mesh {
 	Mesh();
+
+	/**
+	 * @brief Creates a mesh that draws a range of @p arena instead of owning buffers.
+	 */
+	explicit Mesh(std::shared_ptr<MeshArena> arena);
 	Mesh(Mesh&&) = default;
 	Mesh& operator=(Mesh&&) = default;
 
@@ -39,13 +56,47 @@ struct Mesh {
 
 	void render(GLenum mode, GLuint count);
 	void render(GLenum mode);
+	void renderInstanced(GLenum mode, GLsizei instances);
+
+	/**
+	 * @brief Returns the VAO renderInstanced() draws with, its own or the one of its arena.
+	 */
+	QOpenGLVertexArrayObject& getInstancedVertexArray() noexcept;
 
 	QOpenGLBuffer _vbo;
 	QOpenGLBuffer _ibo;
 	QOpenGLVertexArrayObject _vao;
+	QOpenGLVertexArrayObject _instancedVao;  // see SetupInstanceAttributes()
 	std::optional<unsigned int> _materialIndex;  // index to an Assimp material
+	VertexFormat _vertexFormat { VertexFormat::Float };
+	VertexQuantization _quantization;  // of the positions
+	BoundingBox _boundingBox { 0.0f };  // in model space
+	GLenum _indexType { GL_UNSIGNED_INT };  // or GL_UNSIGNED_SHORT
+
+	std::shared_ptr<MeshArena> _arena;  // the buffers are unused if set
+	GLint _baseVertex { 0 };            // within the arena
+	std::size_t _firstIndex { 0 };      // byte offset within the index buffer of the arena
+	GLsizei _numIndices { 0 };
 };
 
+/**
+ * @brief Adds the per instance model matrix at attribute locations 3 to 6 to the bound VAO.
+ * @details The instanced VAO repeats the vertex attributes of a mesh, so the
+ *          VAO of the other draws never fetches instance data. The matrices
+ *          are sourced with BindInstanceBuffer().
+ */
+void SetupInstanceAttributes();
+
+/**
+ * @brief Sources the model matrices of the bound instanced VAO from @p buffer, one per instance.
+ */
+void BindInstanceBuffer(GLuint buffer, std::size_t offset);
+
+/**
+ * @brief Returns the size of an index of type GL_UNSIGNED_INT, GL_UNSIGNED_SHORT or GL_UNSIGNED_BYTE.
+ */
+std::size_t GetIndexSize(GLenum type);
+
 }  // namespace bgl
 
 #endif  // GFX_MESH_HPP_
@@ -0,0 +1,220 @@
+#include <algorithm>
+#include <cmath>
+#include <deque>
+#include <limits>
+#include <stdexcept>
+
+#include "mesh_optimizer.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+/*********************************************************
+ *                      Scoring Code                     *
+ *********************************************************/
+constexpr int cache_size { 32 };  // modelled LRU cache, larger than real caches on purpose
+constexpr float cache_decay_power { 1.5f };
+constexpr float last_triangle_score { 0.75f };
+constexpr float valence_boost_scale { 2.0f };
+constexpr float valence_boost_power { 0.5f };
+
+constexpr std::size_t no_triangle { std::numeric_limits<std::size_t>::max() };
+
+float get_vertex_score(int cache_position, std::size_t num_triangles) noexcept {
+    if (num_triangles == 0) {
+        return -1.0f;  // no triangle left that needs the vertex
+    }
+
+    float score { 0.0f };
+    if (cache_position >= 0) {
+        if (cache_position < 3) {
+            // used by the last triangle, whose order was fixed without regard to the score
+            score = last_triangle_score;
+        } else {
+            const float scale { 1.0f / (cache_size - 3) };
+            score = std::pow(1.0f - (cache_position - 3) * scale, cache_decay_power);
+        }
+    }
+
+    // favours vertices with few triangles left, so no lone triangles are left behind
+    return score + valence_boost_scale * std::pow(static_cast<float>(num_triangles), -valence_boost_power);
+}
+
+struct vertex_info {
+    std::size_t first { 0 };           // offset into the adjacency list
+    std::size_t numTriangles { 0 };    // not yet emitted
+    int cachePosition { -1 };
+    float score { 0.0f };
+};
+
+}  // anonymous namespace
+
+/*********************************************************
+ *                      Statistics                       *
+ *********************************************************/
+float VertexCacheStats::getACMR() const noexcept {
+    return numTriangles == 0 ? 0.0f : static_cast<float>(numTransforms) / numTriangles;
+}
+
+float VertexCacheStats::getATVR() const noexcept {
+    return numVertices == 0 ? 0.0f : static_cast<float>(numTransforms) / numVertices;
+}
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats &rhs) noexcept {
+    numTriangles += rhs.numTriangles;
+    numVertices += rhs.numVertices;
+    numTransforms += rhs.numTransforms;
+    return *this;
+}
+
+VertexCacheStats AnalyzeVertexCache(const std::vector<GLuint> &indices, std::size_t numVertices,
+                                     std::size_t cacheSize) {
+    VertexCacheStats stats;
+    stats.numTriangles = indices.size() / 3;
+    stats.numVertices = numVertices;
+
+    std::vector<std::size_t> timestamps(numVertices, 0);  // of the time a vertex entered the cache
+    std::size_t time { cacheSize + 1 };
+    for (const GLuint index : indices) {
+        if (time - timestamps.at(index) > cacheSize) {
+            timestamps[index] = time++;
+            ++stats.numTransforms;
+        }
+    }
+    return stats;
+}
+
+/*********************************************************
+ *                   Optimization Code                   *
+ *********************************************************/
+void OptimizeVertexCache(std::vector<GLuint> &indices, std::size_t numVertices) {
+    if (indices.size() % 3 != 0) {
+        throw std::invalid_argument { "not a triangle list" };
+    }
+    const std::size_t num_triangles { indices.size() / 3 };
+
+    // triangles per vertex
+    std::vector<vertex_info> vertices(numVertices);
+    for (const GLuint index : indices) {
+        ++vertices.at(index).numTriangles;
+    }
+
+    std::size_t offset { 0 };
+    for (vertex_info &vertex : vertices) {
+        vertex.first = offset;
+        offset += vertex.numTriangles;
+        vertex.numTriangles = 0;
+    }
+
+    std::vector<std::size_t> adjacency(indices.size());
+    for (auto triangle = 0u; triangle < num_triangles; ++triangle) {
+        for (auto corner = 0u; corner < 3; ++corner) {
+            vertex_info &vertex { vertices[indices[3 * triangle + corner]] };
+            adjacency[vertex.first + vertex.numTriangles++] = triangle;
+        }
+    }
+
+    for (vertex_info &vertex : vertices) {
+        vertex.score = get_vertex_score(vertex.cachePosition, vertex.numTriangles);
+    }
+
+    std::vector<float> triangle_scores(num_triangles);
+    std::vector<bool> emitted(num_triangles, false);
+    for (auto triangle = 0u; triangle < num_triangles; ++triangle) {
+        triangle_scores[triangle] = vertices[indices[3 * triangle]].score +
+                                    vertices[indices[3 * triangle + 1]].score +
+                                    vertices[indices[3 * triangle + 2]].score;
+    }
+
+    std::vector<GLuint> optimized;
+    optimized.reserve(indices.size());
+
+    std::deque<GLuint> cache;  // most recently used first
+    std::size_t best { num_triangles == 0 ? no_triangle : static_cast<std::size_t>(
+        std::max_element(triangle_scores.begin(), triangle_scores.end()) - triangle_scores.begin()) };
+    std::size_t cursor { 0 };  // for finding a new start once the cache runs dry
+
+    while (best != no_triangle) {
+        // emit the triangle
+        emitted[best] = true;
+        for (auto corner = 0u; corner < 3; ++corner) {
+            const GLuint index { indices[3 * best + corner] };
+            optimized.push_back(index);
+
+            vertex_info &vertex { vertices[index] };
+            const auto begin { adjacency.begin() + vertex.first };
+            const auto end { begin + vertex.numTriangles };
+            std::iter_swap(std::find(begin, end, best), end - 1);
+            --vertex.numTriangles;
+
+            const auto cached { std::find(cache.begin(), cache.end(), index) };
+            if (cached != cache.end()) {
+                cache.erase(cached);
+            }
+        }
+        for (auto corner = 3u; corner-- > 0;) {
+            cache.push_front(indices[3 * best + corner]);
+        }
+
+        // update the scores of all vertices in and just pushed out of the cache
+        while (cache.size() > static_cast<std::size_t>(cache_size)) {
+            vertex_info &vertex { vertices[cache.back()] };
+            vertex.cachePosition = -1;
+            vertex.score = get_vertex_score(vertex.cachePosition, vertex.numTriangles);
+            cache.pop_back();
+        }
+        for (auto position = 0u; position < cache.size(); ++position) {
+            vertex_info &vertex { vertices[cache[position]] };
+            vertex.cachePosition = static_cast<int>(position);
+            vertex.score = get_vertex_score(vertex.cachePosition, vertex.numTriangles);
+        }
+
+        // the next triangle is the best one touching the cache
+        best = no_triangle;
+        float best_score { -1.0f };
+        for (const GLuint index : cache) {
+            const vertex_info &vertex { vertices[index] };
+            for (auto i = vertex.first; i < vertex.first + vertex.numTriangles; ++i) {
+                const std::size_t triangle { adjacency[i] };
+                triangle_scores[triangle] = vertices[indices[3 * triangle]].score +
+                                            vertices[indices[3 * triangle + 1]].score +
+                                            vertices[indices[3 * triangle + 2]].score;
+                if (triangle_scores[triangle] > best_score) {
+                    best_score = triangle_scores[triangle];
+                    best = triangle;
+                }
+            }
+        }
+
+        if (best == no_triangle) {
+            while (cursor < num_triangles && emitted[cursor]) {
+                ++cursor;
+            }
+            best = cursor < num_triangles ? cursor : no_triangle;
+        }
+    }
+
+    indices = std::move(optimized);
+}
+
+void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<GLuint> &indices) {
+    constexpr GLuint unused { std::numeric_limits<GLuint>::max() };
+    std::vector<GLuint> remap(vertices.size(), unused);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (GLuint &index : indices) {
+        GLuint &new_index { remap.at(index) };
+        if (new_index == unused) {
+            new_index = static_cast<GLuint>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = new_index;
+    }
+
+    vertices = std::move(reordered);
+}
+
+}  // namespace bgl
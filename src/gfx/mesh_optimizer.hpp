@@ -0,0 +1,58 @@
+/**
+ * @file mesh_optimizer.hpp
+ * @brief Reordering of triangles and vertices for the GPU's vertex caches.
+ */
+#ifndef GFX_MESH_OPTIMIZER_HPP_
+#define GFX_MESH_OPTIMIZER_HPP_
+
+#include <cstddef>
+#include <vector>
+
+#include "gl.hpp"
+#include "mesh.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Result of simulating a FIFO post-transform vertex cache.
+ */
+struct VertexCacheStats {
+    std::size_t numTriangles { 0 };
+    std::size_t numVertices { 0 };
+    std::size_t numTransforms { 0 };  // cache misses
+
+    /**
+     * @brief Average cache miss ratio: transformed vertices per triangle (0.5 to 3).
+     */
+    float getACMR() const noexcept;
+
+    /**
+     * @brief Average transform to vertex ratio: transformations per vertex (1 is optimal).
+     */
+    float getATVR() const noexcept;
+
+    VertexCacheStats& operator+=(const VertexCacheStats &rhs) noexcept;
+};
+
+/**
+ * @brief Simulates drawing an indexed triangle list through a FIFO vertex cache.
+ */
+VertexCacheStats AnalyzeVertexCache(const std::vector<GLuint> &indices, std::size_t numVertices,
+                                     std::size_t cacheSize = 16);
+
+/**
+ * @brief Reorders the triangles of an indexed triangle list for vertex cache locality.
+ * @see Tom Forsyth, "Linear-Speed Vertex Cache Optimisation"
+ */
+void OptimizeVertexCache(std::vector<GLuint> &indices, std::size_t numVertices);
+
+/**
+ * @brief Reorders vertices in the order they are first referenced and drops unused ones.
+ * @details Run this after OptimizeVertexCache(), so vertex fetches follow the triangle order.
+ */
+void OptimizeVertexFetch(std::vector<Vertex> &vertices, std::vector<GLuint> &indices);
+
+}  // namespace bgl
+
+#endif  // GFX_MESH_OPTIMIZER_HPP_
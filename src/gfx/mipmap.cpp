@@ -0,0 +1,273 @@
+#include <cmath>
+#include <cstring>   // std::memcpy()
+#include <stdexcept>
+
+#include "mipmap.hpp"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include <QImage>
+
+
+namespace bgl {
+
+namespace {
+
+using rgba = MipLevel::rgba;
+
+/*********************************************************
+ *                       Box Filter Code                 *
+ *********************************************************/
+/**
+ * @brief Averages two source rows into one destination row.
+ * @note @p width is the source width and has to be at least 2.
+ */
+void box_filter_row(const rgba *row0, const rgba *row1, rgba *destination, std::uint32_t width) noexcept {
+    const std::uint32_t destination_width { width / 2 };
+    std::uint32_t x { 0 };
+
+#if defined(__SSE2__)
+    // two destination texels per iteration
+    const __m128i zero { _mm_setzero_si128() };
+    const __m128i rounding { _mm_set1_epi16(2) };
+    for (; x + 2 <= destination_width; x += 2) {
+        const __m128i upper { _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * x)) };
+        const __m128i lower { _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * x)) };
+
+        // vertical sums of texels 0, 1 and 2, 3 as 16 bit channels
+        const __m128i left { _mm_add_epi16(_mm_unpacklo_epi8(upper, zero), _mm_unpacklo_epi8(lower, zero)) };
+        const __m128i right { _mm_add_epi16(_mm_unpackhi_epi8(upper, zero), _mm_unpackhi_epi8(lower, zero)) };
+
+        // horizontal sums: (0 + 1, 2 + 3)
+        __m128i sum { _mm_add_epi16(_mm_unpacklo_epi64(left, right), _mm_unpackhi_epi64(left, right)) };
+        sum = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(destination + x), _mm_packus_epi16(sum, zero));
+    }
+#endif
+
+    for (; x < destination_width; ++x) {
+        for (auto c = 0; c < 4; ++c) {
+            const unsigned sum = row0[2 * x][c] + row0[2 * x + 1][c] + row1[2 * x][c] + row1[2 * x + 1][c];
+            destination[x][c] = static_cast<std::uint8_t>((sum + 2) / 4);
+        }
+    }
+}
+
+MipLevel box_filter(const MipLevel &level) {
+    MipLevel next { std::max(level.width / 2, 1u), std::max(level.height / 2, 1u), {} };
+    next.texels.resize(static_cast<std::size_t>(next.width) * next.height);
+
+    for (auto y = 0u; y < next.height; ++y) {
+        const rgba *row0 { &level.at(0, 2 * y) };
+        const rgba *row1 { &level.at(0, 2 * y + 1) };
+        rgba *destination { &next.texels[y * next.width] };
+
+        if (level.width > 1) {
+            box_filter_row(row0, row1, destination, level.width);
+        } else {
+            for (auto c = 0; c < 4; ++c) {
+                destination[0][c] = static_cast<std::uint8_t>((row0[0][c] + row1[0][c] + 1) / 2);
+            }
+        }
+    }
+    return next;
+}
+
+/*********************************************************
+ *                     Kaiser Filter Code                *
+ *********************************************************/
+constexpr float kaiser_width { 2.0f };  // filter radius in destination texels
+constexpr float kaiser_alpha { 4.0f };
+constexpr float pi { 3.14159265358979f };
+
+/**
+ * @brief Modified Bessel function of the first kind of order 0.
+ */
+float bessel_i0(float x) noexcept {
+    float sum { 1.0f };
+    float term { 1.0f };
+    for (auto k = 1; k < 32 && term > sum * 1e-7f; ++k) {
+        term *= (x * x) / (4.0f * k * k);
+        sum += term;
+    }
+    return sum;
+}
+
+float sinc(float x) noexcept {
+    return std::abs(x) < 1e-6f ? 1.0f : std::sin(pi * x) / (pi * x);
+}
+
+/**
+ * @brief Returns the filter taps for the source texels 2x + i - (N / 2 - 1) of destination texel x.
+ */
+std::vector<float> get_kaiser_weights() {
+    const int radius { static_cast<int>(2 * kaiser_width) };  // in source texels
+    std::vector<float> weights;
+    float sum { 0.0f };
+    for (auto i = -radius + 1; i <= radius; ++i) {
+        const float t { (static_cast<float>(i) - 0.5f) / 2.0f };  // distance in destination texels
+        const float w { t / kaiser_width };
+        const float window { bessel_i0(kaiser_alpha * std::sqrt(std::max(1.0f - w * w, 0.0f))) /
+                             bessel_i0(kaiser_alpha) };
+        weights.push_back(sinc(t) * window);
+        sum += weights.back();
+    }
+    for (float &weight : weights) {
+        weight /= sum;
+    }
+    return weights;
+}
+
+#if defined(__SSE2__)
+using float4 = __m128;
+
+inline float4 load(const rgba &texel) noexcept {
+    std::int32_t packed;
+    std::memcpy(&packed, texel.data(), sizeof(packed));
+    const __m128i zero { _mm_setzero_si128() };
+    const __m128i words { _mm_unpacklo_epi8(_mm_cvtsi32_si128(packed), zero) };
+    return _mm_cvtepi32_ps(_mm_unpacklo_epi16(words, zero));
+}
+
+inline rgba store(float4 value) noexcept {
+    const __m128i dwords { _mm_cvtps_epi32(value) };  // rounds to nearest
+    const __m128i words { _mm_packs_epi32(dwords, dwords) };
+    const std::int32_t packed { _mm_cvtsi128_si32(_mm_packus_epi16(words, words)) };  // saturates to [0, 255]
+    rgba texel;
+    std::memcpy(texel.data(), &packed, sizeof(packed));
+    return texel;
+}
+
+inline float4 zero4() noexcept {
+    return _mm_setzero_ps();
+}
+
+inline float4 load(const float *value) noexcept {
+    return _mm_loadu_ps(value);
+}
+
+inline void store(float *destination, float4 value) noexcept {
+    _mm_storeu_ps(destination, value);
+}
+
+inline float4 multiply_add(float4 sum, float4 value, float weight) noexcept {
+    return _mm_add_ps(sum, _mm_mul_ps(value, _mm_set1_ps(weight)));
+}
+#else
+using float4 = std::array<float, 4>;
+
+inline float4 load(const rgba &texel) noexcept {
+    return { float(texel[0]), float(texel[1]), float(texel[2]), float(texel[3]) };
+}
+
+inline rgba store(const float4 &value) noexcept {
+    rgba texel;
+    for (auto c = 0; c < 4; ++c) {
+        texel[c] = static_cast<std::uint8_t>(std::clamp(std::lround(value[c]), 0l, 255l));
+    }
+    return texel;
+}
+
+inline float4 zero4() noexcept {
+    return {};
+}
+
+inline float4 load(const float *value) noexcept {
+    return { value[0], value[1], value[2], value[3] };
+}
+
+inline void store(float *destination, const float4 &value) noexcept {
+    std::copy(value.begin(), value.end(), destination);
+}
+
+inline float4 multiply_add(float4 sum, const float4 &value, float weight) noexcept {
+    for (auto c = 0; c < 4; ++c) {
+        sum[c] += value[c] * weight;
+    }
+    return sum;
+}
+#endif
+
+MipLevel kaiser_filter(const MipLevel &level) {
+    static const std::vector<float> weights { get_kaiser_weights() };
+    const int offset { static_cast<int>(weights.size() / 2) - 1 };
+
+    const auto clamp = [] (int i, std::uint32_t size) {
+        return static_cast<std::uint32_t>(std::clamp(i, 0, static_cast<int>(size) - 1));
+    };
+
+    MipLevel next { std::max(level.width / 2, 1u), std::max(level.height / 2, 1u), {} };
+    next.texels.resize(static_cast<std::size_t>(next.width) * next.height);
+
+    // horizontal pass: one filtered row per source row, 4 floats per texel
+    std::vector<float> rows(static_cast<std::size_t>(next.width) * level.height * 4);
+    for (auto y = 0u; y < level.height; ++y) {
+        const rgba *source { &level.texels[y * level.width] };
+        float *destination { &rows[y * next.width * 4] };
+        for (auto x = 0u; x < next.width; ++x) {
+            float4 sum { zero4() };
+            for (auto i = 0u; i < weights.size(); ++i) {
+                const rgba &texel { source[clamp(static_cast<int>(2 * x + i) - offset, level.width)] };
+                sum = multiply_add(sum, load(texel), weights[i]);
+            }
+            store(destination + 4 * x, sum);
+        }
+    }
+
+    // vertical pass: accumulates whole rows
+    std::vector<float> sums(static_cast<std::size_t>(next.width) * 4);
+    for (auto y = 0u; y < next.height; ++y) {
+        std::fill(sums.begin(), sums.end(), 0.0f);
+        for (auto i = 0u; i < weights.size(); ++i) {
+            const float *row { &rows[clamp(static_cast<int>(2 * y + i) - offset, level.height) * next.width * 4] };
+            for (auto x = 0u; x < next.width; ++x) {
+                store(&sums[4 * x], multiply_add(load(&sums[4 * x]), load(row + 4 * x), weights[i]));
+            }
+        }
+
+        rgba *destination { &next.texels[y * next.width] };
+        for (auto x = 0u; x < next.width; ++x) {
+            destination[x] = store(load(&sums[4 * x]));
+        }
+    }
+    return next;
+}
+
+}  // anonymous namespace
+
+MipLevel GetMipLevel(const QImage &image) {
+    if (image.isNull()) {
+        throw std::invalid_argument { "cannot create a mip level from an empty image" };
+    }
+
+    const QImage rgba8 { image.convertToFormat(QImage::Format_RGBA8888) };
+    MipLevel level { static_cast<std::uint32_t>(rgba8.width()), static_cast<std::uint32_t>(rgba8.height()), {} };
+    level.texels.resize(static_cast<std::size_t>(level.width) * level.height);
+    for (auto y = 0u; y < level.height; ++y) {
+        std::memcpy(&level.texels[y * level.width], rgba8.constScanLine(y), level.width * sizeof(rgba));
+    }
+    return level;
+}
+
+MipLevel Downsample(const MipLevel &level, MipFilter filter) {
+    switch (filter) {
+        case MipFilter::Box:
+            return box_filter(level);
+        case MipFilter::Kaiser:
+            return kaiser_filter(level);
+    }
+    throw std::invalid_argument { "unknown mip filter" };
+}
+
+std::vector<MipLevel> GenerateMipChain(const QImage &image, MipFilter filter) {
+    std::vector<MipLevel> levels;
+    levels.push_back(GetMipLevel(image));
+    while (levels.back().width > 1 || levels.back().height > 1) {
+        levels.push_back(Downsample(levels.back(), filter));
+    }
+    return levels;
+}
+
+}  // namespace bgl
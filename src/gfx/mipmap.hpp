@@ -0,0 +1,59 @@
+/**
+ * @file mipmap.hpp
+ * @brief Generation of mip chains on the CPU.
+ */
+#ifndef GFX_MIPMAP_HPP_
+#define GFX_MIPMAP_HPP_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <vector>
+
+class QImage;
+
+
+namespace bgl {
+
+enum class MipFilter {
+    Box,    // 2x2 average, fast
+    Kaiser  // Kaiser windowed sinc, sharper distant textures
+};
+
+/**
+ * @brief One RGBA8 mip level, stored row by row.
+ */
+struct MipLevel {
+    using rgba = std::array<std::uint8_t, 4>;
+
+    std::uint32_t width;
+    std::uint32_t height;
+    std::vector<rgba> texels;
+
+    /**
+     * @brief Returns a texel, clamping the coordinates to the edges.
+     */
+    const rgba& at(std::uint32_t x, std::uint32_t y) const noexcept {
+        return texels[std::min(y, height - 1) * width + std::min(x, width - 1)];
+    }
+};
+
+/**
+ * @brief Converts an image into a RGBA8 mip level.
+ */
+MipLevel GetMipLevel(const QImage &image);
+
+/**
+ * @brief Halves the size of a mip level.
+ */
+MipLevel Downsample(const MipLevel &level, MipFilter filter);
+
+/**
+ * @brief Generates the full mip chain of an image down to 1x1.
+ * @return All levels, level 0 first.
+ */
+std::vector<MipLevel> GenerateMipChain(const QImage &image, MipFilter filter);
+
+}  // namespace bgl
+
+#endif  // GFX_MIPMAP_HPP_
@@ -6,12 +6,22 @@
 #include <QOpenGLTexture>
 
 #include <algorithm>
+#include <cstddef>
+#include <cstring>  // std::memcpy()
 #include <iostream>
+#include <iterator>  // std::back_inserter()
+#include <limits>
 #include <list>
+#include <optional>
+#include <stdexcept>
 #include <string>
 
 #include "model.hpp"
 #include "box.hpp"
+#include "frustum.hpp"
+#include "state_tracker.hpp"
+#include "stream_buffer.hpp"
+#include "uniforms.hpp"
 
 
 namespace bgl {
@@ -22,61 +32,328 @@ inline QVector3D to_qt(const glm::vec3 &v) noexcept {
     return { v.x, v.y, v.z };
 }
 
-/*********************************************************
- *                      Lighting Code                    *
- *********************************************************/
-void setupLight(QOpenGLShaderProgram &program /* NOLINT */, const DirectionalLight &light) {
-    program.setUniformValue("light.direction", to_qt(light.direction));
-    program.setUniformValue("light.diffuse", to_qt(light.diffuse));
-    program.setUniformValue("light.ambient", to_qt(light.ambient));
+inline QVector2D to_qt(const glm::vec2 &v) noexcept {
+    return { v.x, v.y };
 }
 
 void setupTexture(QOpenGLShaderProgram &program /* NOLINT */, QOpenGLTexture &texture,
-                  const std::string &name, GLuint textureUnit = 0) {
-    glActiveTexture(GL_TEXTURE0 + textureUnit);
-    texture.bind();
-    program.setUniformValue(name.c_str(), textureUnit);
+                  const Sampler *sampler, GLint location, GLuint textureUnit = 0) {
+    StateTracker::instance().bindTexture(textureUnit, texture, sampler);
+    program.setUniformValue(location, textureUnit);
+    StateTracker::instance().countUniformUpdates(1);
 }
 
-void setupMaterial(QOpenGLShaderProgram &program /* NOLINT */, const Material &material) {
-    program.setUniformValue("material.ambient", to_qt(material.ambient));
-    program.setUniformValue("material.diffuse", to_qt(material.diffuse));
-    program.setUniformValue("material.specular", to_qt(material.specular));
-    program.setUniformValue("material.shininess", material.shininess);
+void setupVertexFormat(QOpenGLShaderProgram &program /* NOLINT */, const ModelUniforms &uniforms,
+                       const Mesh &mesh) {
+    if (!StateTracker::instance().setVertexFormat(mesh._vertexFormat, mesh._quantization)) {
+        return;
+    }
 
-    /**
-     * @note There is currently only support for diffuse texture maps. 
-     */
-    const GLuint isTextured { material.textures.diffuse != nullptr };
-    program.setUniformValue("material.isTextured", isTextured);
-    if (isTextured) {
-        setupTexture(program, *material.textures.diffuse, "material.texture");
+    program.setUniformValue(uniforms.vertexFormat.offset, to_qt(mesh._quantization.offset));
+    program.setUniformValue(uniforms.vertexFormat.scale, to_qt(mesh._quantization.scale));
+    const GLuint isOctahedral { mesh._vertexFormat == VertexFormat::Compact };
+    program.setUniformValue(uniforms.vertexFormat.octahedral, isOctahedral);
+    program.setUniformValue(uniforms.vertexFormat.texcoordOffset, to_qt(mesh._quantization.texcoordOffset));
+    program.setUniformValue(uniforms.vertexFormat.texcoordScale, to_qt(mesh._quantization.texcoordScale));
+    StateTracker::instance().countUniformUpdates(5);
+}
+
+/*********************************************************
+ *                      Material Code                    *
+ *********************************************************/
+/**
+ * @brief Binds the block of a material within the material buffer.
+ */
+void setupMaterial(QOpenGLShaderProgram &program /* NOLINT */, const ModelUniforms &uniforms,
+                   const Material &material, const UniformBuffer &buffer, std::size_t offset) {
+    if (!StateTracker::instance().setMaterial(&material)) {
+        return;
+    }
+
+    buffer.bind(UniformBlock::Material, offset, sizeof(MaterialBlock));
+    if (material.textures.diffuse) {
+        setupTexture(program, *material.textures.diffuse, material.sampler.get(), uniforms.texture);
     }
 }
 
+ModelUniforms get_uniforms(const UniformTable &table) {
+    ModelUniforms uniforms;
+    uniforms.MVP = table.getLocation("MVP");
+    uniforms.VP = table.getLocation("VP");
+    uniforms.texture = table.getLocation("materialTexture");
+    uniforms.vertexFormat.offset = table.getLocation("vertexFormat.offset");
+    uniforms.vertexFormat.scale = table.getLocation("vertexFormat.scale");
+    uniforms.vertexFormat.octahedral = table.getLocation("vertexFormat.octahedral");
+    uniforms.vertexFormat.texcoordOffset = table.getLocation("vertexFormat.texcoordOffset");
+    uniforms.vertexFormat.texcoordScale = table.getLocation("vertexFormat.texcoordScale");
+    return uniforms;
+}
+
 }  // anonymous namespace
 
 
+void Model::setMaterials(std::vector<Material> materials) {
+    _materials = materials;
+    _drawList.clear();
+    _indirectDrawList.reset();
+    if (_materials.empty()) {
+        return;
+    }
+
+    _materialStride = GetUniformBufferStride(sizeof(MaterialBlock));
+    std::vector<std::byte> blocks(_materials.size() * _materialStride);
+    for (auto i = 0u; i < _materials.size(); ++i) {
+        const MaterialBlock block { GetMaterialBlock(_materials[i]) };
+        std::memcpy(blocks.data() + i * _materialStride, &block, sizeof(block));
+    }
+    _materialBuffer.allocate(blocks.data(), blocks.size());
+}
+
+void Model::setProgram(std::shared_ptr<QOpenGLShaderProgram> program) {
+    _program = program;
+    _uniforms = program ? get_uniforms(UniformTable { *program }) : ModelUniforms {};
+    if (program) {
+        BindUniformBlocks(*program);
+        _frameUniforms = GetFrameUniforms();
+    }
+    _drawList.clear();
+    _indirectDrawList.reset();
+}
+
+void Model::setIndirectProgram(std::shared_ptr<QOpenGLShaderProgram> program) {
+    _indirectProgram = program;
+    _indirectUniforms = program ? get_uniforms(UniformTable { *program }) : ModelUniforms {};
+    if (program) {
+        BindUniformBlocks(*program);
+    }
+    _indirectDrawList.reset();
+}
+
+void Model::updateDrawList() {
+    if (!_drawList.empty() || _meshes.empty()) {
+        return;
+    }
+
+    for (Mesh &mesh : _meshes) {
+        const Material *material { mesh._materialIndex.has_value() ? &_materials.at(mesh._materialIndex.value())
+                                                                  : nullptr };
+        _drawList.push_back({ _program.get(), material, &mesh });
+    }
+    SortDrawCommands(_drawList);
+
+    _drawBoxes.clear();
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (const DrawCommand &command : _drawList) {
+        const BoundingBox &box { command.mesh->_boundingBox };
+        _drawBoxes.push_back(box);
+        min = glm::min(min, box.getMin());
+        max = glm::max(max, box.getMax());
+    }
+    _meshBounds = BoundingBox { (min + max) / 2.0f, max - min };
+}
+
+void Model::setInstancedProgram(std::shared_ptr<QOpenGLShaderProgram> program) {
+    _instancedProgram = program;
+    _instancedUniforms = program ? get_uniforms(UniformTable { *program }) : ModelUniforms {};
+    if (program) {
+        BindUniformBlocks(*program);
+    }
+}
+
+bool Model::updateIndirectDrawList() {
+    if (_indirectDrawList) {
+        return true;
+    }
+
+    const auto is_shared { [] (const Mesh &mesh) { return mesh._arena != nullptr; } };
+    if (!_indirectProgram || _drawList.empty() || !std::all_of(_meshes.begin(), _meshes.end(), is_shared)) {
+        return false;
+    }
+
+    _indirectDrawList = std::make_unique<IndirectDrawList>(_drawList, _materials);
+    std::cout << "drawing " << _indirectDrawList->getNumDraws() << " meshes with "
+              << _indirectDrawList->getNumBatches() << " indirect draw calls" << std::endl;
+    return true;
+}
+
+void Model::renderIndirect(const QMatrix4x4 &MVP, const std::vector<std::uint8_t> &visible) {
+    StateTracker &tracker { StateTracker::instance() };
+    QOpenGLShaderProgram &program { *_indirectProgram };
+    if (tracker.bindProgram(program)) {
+        program.setUniformValue(_indirectUniforms.MVP, MVP.transposed());
+        program.setUniformValue(_indirectUniforms.texture, GLuint { 0 });
+        tracker.countUniformUpdates(2);
+    }
+    _indirectDrawList->render(visible, 0);
+}
+
 void Model::render(const mat4 &MVP, const DirectionalLight &light) {
-     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
-    _program->bind();
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+    updateDrawList();
 
-    setupLight(*_program, light);
+    StateTracker &tracker { StateTracker::instance() };
+    tracker.invalidate();  // other objects bind their own programs and textures
+    if (_frameUniforms) {
+        _frameUniforms->setLight(light);  // streamed once per frame
+    }
+
+    if (_sceneGraph) {
+        renderNodes(MVP);
+        return;
+    }
+
+    // the planes of the frustum are in model space, as are the boxes of the meshes
+    const std::size_t num_visible { Frustum { MVP }.cull(_drawBoxes, _visible) };
+    tracker.countCulling(num_visible, _drawList.size() - num_visible);
 
     const QMatrix4x4 matrix { glm::value_ptr(MVP) };
-    _program->setUniformValue("MVP", matrix.transposed());
+    if (updateIndirectDrawList()) {
+        renderIndirect(matrix, _visible);
+        return;
+    }
 
     /**
      * @brief Render a mesh for each material as there is is one VBO per material
      * @details http://assimp.sourceforge.net/lib_html/materials.html
      */
-    for (auto i = 0u; i < _meshes.size(); ++i) {
-        if (_meshes[i]._materialIndex.has_value()) {
-            const unsigned int material_index { _meshes[i]._materialIndex.value() };
-            setupMaterial(*_program, _materials[material_index]);
+    for (auto i = 0u; i < _drawList.size(); ++i) {
+        if (!_visible[i]) {
+            continue;
+        }
+
+        const DrawCommand &command { _drawList[i] };
+        QOpenGLShaderProgram &program { *command.program };
+        if (tracker.bindProgram(program)) {
+            program.setUniformValue(_uniforms.MVP, matrix.transposed());
+            tracker.countUniformUpdates(1);
+        }
+
+        if (command.material) {
+            const auto index { static_cast<std::size_t>(command.material - _materials.data()) };
+            setupMaterial(program, _uniforms, *command.material, _materialBuffer, index * _materialStride);
+        }
+        setupVertexFormat(program, _uniforms, *command.mesh);
+        command.mesh->render(GL_TRIANGLES);
+        tracker.countDrawCall();
+    }
+    tracker.releaseVertexArray();  // the VAO of a mesh arena must not capture the buffers of others
+}
+
+/**
+ * @brief Draws each mesh once per node that refers to it, in the order of the draw list.
+ */
+void Model::renderNodes(const mat4 &MVP) {
+    StateTracker &tracker { StateTracker::instance() };
+    _sceneGraph->update();
+
+    const Frustum frustum { MVP };
+    std::size_t num_visible { 0 };
+    std::size_t num_culled { 0 };
+    for (const DrawCommand &command : _drawList) {
+        const auto mesh { static_cast<std::uint32_t>(command.mesh - _meshes.data()) };
+        for (const std::uint32_t node : _sceneGraph->getInstances(mesh)) {
+            const mat4 &transform { _sceneGraph->getWorldTransform(node) };
+            if (!frustum.intersects(command.mesh->_boundingBox, transform)) {
+                ++num_culled;
+                continue;
+            }
+            ++num_visible;
+
+            QOpenGLShaderProgram &program { *command.program };
+            tracker.bindProgram(program);
+            const QMatrix4x4 matrix { glm::value_ptr(MVP * transform) };
+            program.setUniformValue(_uniforms.MVP, matrix.transposed());
+            tracker.countUniformUpdates(1);
+
+            if (command.material) {
+                const auto index { static_cast<std::size_t>(command.material - _materials.data()) };
+                setupMaterial(program, _uniforms, *command.material, _materialBuffer, index * _materialStride);
+            }
+            setupVertexFormat(program, _uniforms, *command.mesh);
+            command.mesh->render(GL_TRIANGLES);
+            tracker.countDrawCall();
+        }
+    }
+
+    tracker.countCulling(num_visible, num_culled);
+    tracker.releaseVertexArray();
+}
+
+std::size_t Model::renderInstanced(const mat4 &VP, const std::vector<mat4> &transforms,
+                                   const DirectionalLight &light) {
+    if (!_instancedProgram) {
+        throw std::logic_error { "model has no instanced program" };
+    }
+    if (_sceneGraph) {
+        throw std::logic_error { "models with a scene graph cannot be drawn instanced" };
+    }
+
+    updateDrawList();
+    if (_drawList.empty()) {
+        return 0;
+    }
+
+    const Frustum frustum { VP };
+    _visibleInstances.clear();
+    std::copy_if(transforms.begin(), transforms.end(), std::back_inserter(_visibleInstances),
+                 [&] (const mat4 &transform) { return frustum.intersects(_meshBounds, transform); });
+    if (_visibleInstances.empty()) {
+        return 0;
+    }
+
+    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+
+    StateTracker &tracker { StateTracker::instance() };
+    tracker.invalidate();
+    if (_frameUniforms) {
+        _frameUniforms->setLight(light);
+    }
+
+    const std::size_t size { _visibleInstances.size() * sizeof(mat4) };
+    std::optional<StreamAllocation> instances_allocation { StreamBuffer::instance().write(_visibleInstances.data(),
+                                                                                          size) };
+    if (!instances_allocation.has_value()) {  // the stream grows with the next frame
+        if (!_instanceBuffer.isCreated()) {
+            _instanceBuffer.create();
+            _instanceBuffer.setUsagePattern(QOpenGLBuffer::StreamDraw);
         }
-        _meshes[i].render(GL_TRIANGLES);
+        _instanceBuffer.bind();
+        _instanceBuffer.allocate(_visibleInstances.data(), static_cast<int>(size));
+        _instanceBuffer.release();
+        instances_allocation = StreamAllocation { _instanceBuffer.bufferId(), 0 };
     }
+
+    // meshes in an arena share their VAO, the attribute formats were set up by the import
+    _instancedVertexArrays.clear();
+    for (Mesh &mesh : _meshes) {
+        QOpenGLVertexArrayObject *vao { &mesh.getInstancedVertexArray() };
+        if (std::find(_instancedVertexArrays.begin(), _instancedVertexArrays.end(), vao) ==
+            _instancedVertexArrays.end()) {
+            tracker.bindVertexArray(*vao);
+            BindInstanceBuffer(instances_allocation->buffer, instances_allocation->offset);
+            _instancedVertexArrays.push_back(vao);
+        }
+    }
+
+    QOpenGLShaderProgram &program { *_instancedProgram };
+    tracker.bindProgram(program);
+    const QMatrix4x4 matrix { glm::value_ptr(VP) };
+    program.setUniformValue(_instancedUniforms.VP, matrix.transposed());
+    tracker.countUniformUpdates(1);
+
+    const auto instances { static_cast<GLsizei>(_visibleInstances.size()) };
+    for (const DrawCommand &command : _drawList) {
+        if (command.material) {
+            const auto index { static_cast<std::size_t>(command.material - _materials.data()) };
+            setupMaterial(program, _instancedUniforms, *command.material, _materialBuffer, index * _materialStride);
+        }
+        setupVertexFormat(program, _instancedUniforms, *command.mesh);
+        command.mesh->renderInstanced(GL_TRIANGLES, instances);
+        tracker.countDrawCall();
+    }
+    tracker.releaseVertexArray();
+    return _visibleInstances.size();
 }
 
 void Model::render(const mat4 &MVP) {
@@ -91,4 +368,16 @@ const BoundingBox& Model::getBoundingBox() const {
     return _boundingBox;
 }
 
+const Bvh& Model::getMeshBvh() {
+    if (_meshBvh.empty() && !_meshes.empty()) {
+        std::vector<BoundingBox> boxes;
+        boxes.reserve(_meshes.size());
+        for (const Mesh &mesh : _meshes) {
+            boxes.push_back(mesh._boundingBox);
+        }
+        _meshBvh = Bvh { boxes };
+    }
+    return _meshBvh;
+}
+
 }  // namespace bgl
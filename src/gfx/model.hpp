@@ -2,21 +2,49 @@
 #ifndef GFX_MODEL_HPP_
 #define GFX_MODEL_HPP_
 
+#include <cstdint>
 #include <filesystem>
-#include <memory>  // std::shared_ptr
+#include <map>
+#include <memory>  // std::shared_ptr, std::unique_ptr
+#include <string>
+#include <utility>  // std::move()
 #include <vector>
 
 #include "gl.hpp"
 #include "mesh.hpp"
 #include "material.hpp"
+#include "mipmap.hpp"
+#include "sampler.hpp"
 #include "bounding_box.hpp"
+#include "bvh.hpp"
+#include "draw_list.hpp"
+#include "frustum.hpp"
+#include "indirect_draw.hpp"
+#include "uniform_buffer.hpp"
 #include "scene.hpp"
+#include "scene_graph.hpp"
 
 #include <QOpenGLShaderProgram>  // NOLINT
 
 
 namespace bgl {
 
+/**
+ * @brief Uniform locations of the program of a Model, resolved once per program.
+ */
+struct ModelUniforms {
+	GLint MVP { -1 };
+	GLint VP { -1 };       // of the instanced program
+	GLint texture { -1 };  // the light and the materials are uniform blocks
+	struct {
+		GLint offset { -1 };
+		GLint scale { -1 };
+		GLint octahedral { -1 };
+		GLint texcoordOffset { -1 };
+		GLint texcoordScale { -1 };
+	} vertexFormat;
+};
+
 /**
  * @brief An OpenGL renderable mesh.
  */
@@ -34,29 +62,111 @@ class Model {
 	virtual void render(const mat4 &MVP);
 	virtual void render(const mat4 &MVP, const DirectionalLight &light);
 
+	/**
+	 * @brief Draws one copy of the model per transform with glDrawElementsInstanced().
+	 * @details Copies whose meshes are all outside the view frustum are
+	 *          culled on the CPU, the others are streamed into an instance buffer.
+	 * @param VP The view projection matrix, the transforms are the model matrices.
+	 * @return The number of copies that were drawn.
+	 * @note Requires an instanced program (see setInstancedProgram()). Models with
+	 *       a SceneGraph cannot be drawn instanced, the node transforms would be lost.
+	 */
+	std::size_t renderInstanced(const mat4 &VP, const std::vector<mat4> &transforms,
+	                            const DirectionalLight &light);
+
 	void resize(const vec3 &dimensions);
 	const BoundingBox& getBoundingBox() const;
 
-	void setMaterials(std::vector<Material> materials) {
-		_materials = materials;
+	/**
+	 * @brief Sets the materials and uploads them into the material uniform buffer.
+	 */
+	void setMaterials(std::vector<Material> materials);
+
+	/**
+	 * @brief Sets the program of all meshes and resolves its uniform locations.
+	 */
+	void setProgram(std::shared_ptr<QOpenGLShaderProgram> program);
+
+	/**
+	 * @brief Sets the program that draws the whole model with glMultiDrawElementsIndirect().
+	 * @details Without it, or with meshes that do not share their buffers, the
+	 *          meshes are drawn one by one with the program of setProgram().
+	 * @note Requires IsIndirectDrawingSupported().
+	 */
+	void setIndirectProgram(std::shared_ptr<QOpenGLShaderProgram> program);
+
+	/**
+	 * @brief Sets the program of renderInstanced(), it reads the model matrix from attribute locations 3 to 6.
+	 */
+	void setInstancedProgram(std::shared_ptr<QOpenGLShaderProgram> program);
+
+	void setBoundingBox(const BoundingBox &boundingBox) {
+		_boundingBox = boundingBox;
 	}
 
-	void setProgram(std::shared_ptr<QOpenGLShaderProgram> program) {
-		_program = program;
+	/**
+	 * @brief Sets how many bytes of index data the meshes save by using 16-bit indices.
+	 */
+	void setIndexBytesSaved(std::size_t bytes) noexcept {
+		_indexBytesSaved = bytes;
 	}
 
-	void setBoundingBox(const BoundingBox &boundingBox) {
-		_boundingBox = boundingBox;
+	std::size_t getIndexBytesSaved() const noexcept {
+		return _indexBytesSaved;
 	}
 
 	const std::vector<Mesh>& getMeshes() const noexcept {
 		return _meshes;
 	}
 
+	/**
+	 * @brief Gives access to the meshes to change them.
+	 * @note Call invalidateDrawList() after changing the meshes.
+	 */
 	std::vector<Mesh>& getMeshes() noexcept {
 		return _meshes;
 	}
 
+	/**
+	 * @brief Rebuilds the draw lists and the mesh Bvh on the next use, e.g. after the meshes changed.
+	 */
+	void invalidateDrawList() noexcept {
+		_drawList.clear();
+		_indirectDrawList.reset();
+		_meshBvh = {};
+	}
+
+	/**
+	 * @brief Returns a Bvh over the bounding boxes of the meshes, built on first use.
+	 */
+	const Bvh& getMeshBvh();
+
+	/**
+	 * @brief Sets the triangles of all meshes, kept on the CPU for picking and spatial queries.
+	 */
+	void setTriangleBvh(std::shared_ptr<const TriangleBvh> triangles) noexcept {
+		_triangleBvh = std::move(triangles);
+	}
+
+	/**
+	 * @brief Returns the triangles of all meshes or nothing if they were not kept (see ImportOptions).
+	 */
+	const std::shared_ptr<const TriangleBvh>& getTriangleBvh() const noexcept {
+		return _triangleBvh;
+	}
+
+	/**
+	 * @brief Sets the node hierarchy the meshes are drawn with, once per node that refers to them.
+	 * @details Without it, each mesh is drawn once with the matrix passed to render().
+	 */
+	void setSceneGraph(std::shared_ptr<SceneGraph> sceneGraph) noexcept {
+		_sceneGraph = std::move(sceneGraph);
+	}
+
+	const std::shared_ptr<SceneGraph>& getSceneGraph() const noexcept {
+		return _sceneGraph;
+	}
+
 	const std::shared_ptr<QOpenGLShaderProgram> getProgram() const noexcept {
 		return _program;
 	}
@@ -66,13 +176,62 @@ class Model {
 	std::vector<Material> _materials;
 
 	std::shared_ptr<QOpenGLShaderProgram> _program;
+	ModelUniforms _uniforms;
 	BoundingBox _boundingBox;
+	std::size_t _indexBytesSaved { 0 };
+
+ private:
+	void updateDrawList();
+	bool updateIndirectDrawList();
+	void renderIndirect(const QMatrix4x4 &MVP, const std::vector<std::uint8_t> &visible);
+	void renderNodes(const mat4 &MVP);
+
+	std::vector<DrawCommand> _drawList;  // sorted, rebuilt when empty
+	BoxArray _drawBoxes;                 // of the meshes of the draw list
+	BoundingBox _meshBounds;             // enclosing all meshes, rebuilt with the draw list
+	std::vector<std::uint8_t> _visible;  // whether each draw command is inside the view frustum
+	std::shared_ptr<QOpenGLShaderProgram> _indirectProgram;
+	ModelUniforms _indirectUniforms;
+	std::unique_ptr<IndirectDrawList> _indirectDrawList;  // rebuilt with the draw list
+
+	std::shared_ptr<QOpenGLShaderProgram> _instancedProgram;
+	ModelUniforms _instancedUniforms;
+	QOpenGLBuffer _instanceBuffer;        // model matrices of the visible copies if they do not fit into the stream
+	std::vector<mat4> _visibleInstances;  // reused between frames
+	std::vector<QOpenGLVertexArrayObject*> _instancedVertexArrays;  // of the meshes, reused between frames
+	UniformBuffer _materialBuffer;       // one MaterialBlock per material
+	std::size_t _materialStride { 0 };   // of the blocks within the buffer
+	std::shared_ptr<FrameUniforms> _frameUniforms;
+
+	Bvh _meshBvh;                                // rebuilt when empty
+	std::shared_ptr<const TriangleBvh> _triangleBvh;
+	std::shared_ptr<SceneGraph> _sceneGraph;
+};
+
+/**
+ * @brief Options controlling how a 3D model file is imported.
+ */
+struct ImportOptions {
+	bool useCache { true };             // read and write a binary cache next to the model file
+	bool reportMemoryUsage { false };   // print the peak RSS during the load
+	bool compressTextures { true };     // upload textures block compressed if supported
+	MipFilter mipFilter { MipFilter::Kaiser };
+	TextureFilter textureFilter { TextureFilter::Anisotropic };  // sampler of materials not listed below
+	std::map<std::string, TextureFilter> materialTextureFilters;  // sampler per material name
+	bool optimizeMeshes { true };       // reorder triangles and vertices for the vertex caches, kept in the cache
+	VertexFormat vertexFormat { VertexFormat::Compact };  // of meshes within the error limits
+	bool shareBuffers { true };         // pack all meshes into one vertex and index buffer per vertex format
+	bool drawIndirect { true };         // submit shared buffers with glMultiDrawElementsIndirect() if supported
+	bool buildTriangleBvh { false };    // keep the triangles on the CPU in a BVH (see Model::getTriangleBvh())
+	bool preTransformVertices { true }; // bake the node transforms into the vertices instead of keeping
+	                                    // the node hierarchy in a SceneGraph
 };
 
 /**
  * @brief Loads a 3D model file.
  */
-std::shared_ptr<Model> LoadModel(const std::filesystem::path &path);  // TODO defined in importer.cpp
+std::shared_ptr<Model> LoadModel(const std::filesystem::path &path,
+                                 const ImportOptions &options = {});  // TODO defined in importer.cpp
 
 }  // namespace bgl
 
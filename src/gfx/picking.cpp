@@ -0,0 +1,59 @@
+#include <cstdint>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "picking.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+/**
+ * @brief Returns the mesh and the node of an instance in the order the importer copied them into the TriangleBvh.
+ */
+std::pair<std::size_t, std::uint32_t> locate_instance(const SceneGraph &graph, std::size_t numMeshes,
+                                                      std::size_t instance) {
+    for (auto mesh = 0u; mesh < numMeshes; ++mesh) {
+        const std::vector<std::uint32_t> &nodes { graph.getInstances(mesh) };
+        if (instance < nodes.size()) {
+            return { mesh, nodes[instance] };
+        }
+        instance -= nodes.size();
+    }
+    throw std::out_of_range { "invalid mesh instance" };
+}
+
+}  // anonymous namespace
+
+Ray Unproject(const mat4 &viewProjection, const vec2 &position) {
+    const mat4 inverse { glm::inverse(viewProjection) };
+    const vec4 near { inverse * vec4 { position.x, position.y, -1.0f, 1.0f } };
+    const vec4 far { inverse * vec4 { position.x, position.y, 1.0f, 1.0f } };
+
+    const vec3 origin { vec3 { near } / near.w };
+    return { origin, glm::normalize(vec3 { far } / far.w - origin) };
+}
+
+std::optional<PickResult> Pick(const Model &model, const Ray &ray) {
+    const std::shared_ptr<const TriangleBvh> &triangles { model.getTriangleBvh() };
+    if (!triangles) {
+        throw std::invalid_argument { "the model has no triangles to pick" };
+    }
+
+    const std::optional<RayHit> hit { triangles->intersect(ray) };
+    if (!hit) {
+        return {};
+    }
+
+    const auto [instance, triangle] = triangles->locate(hit->triangle);
+    if (!model.getSceneGraph()) {
+        return PickResult { instance, SceneGraph::none, triangle, hit->point, hit->distance };
+    }
+
+    const auto [mesh, node] = locate_instance(*model.getSceneGraph(), model.getMeshes().size(), instance);
+    return PickResult { mesh, node, triangle, hit->point, hit->distance };
+}
+
+}  // namespace bgl
@@ -0,0 +1,46 @@
+/**
+ * @file picking.hpp
+ * @brief Picking of model triangles with rays through the viewport.
+ */
+#ifndef GFX_PICKING_HPP_
+#define GFX_PICKING_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+#include "math.hpp"
+#include "bvh.hpp"
+#include "model.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief A picked triangle of a model.
+ */
+struct PickResult {
+	std::size_t mesh;      // index into Model::getMeshes()
+	std::uint32_t node;    // of the scene graph that draws the mesh, or SceneGraph::none without one
+	std::size_t triangle;  // within the mesh
+	vec3 point;            // in model space
+	float distance;        // from the origin of the ray
+};
+
+/**
+ * @brief Returns the ray from the near to the far plane through a point of the viewport.
+ * @param viewProjection The matrix the scene is rendered with, e.g. Camera::matrix().
+ * @param position In normalized device coordinates [-1, 1].
+ */
+Ray Unproject(const mat4 &viewProjection, const vec2 &position);
+
+/**
+ * @brief Returns the closest triangle of @p model hit by @p ray.
+ * @note Requires the triangles of the model (see ImportOptions::buildTriangleBvh).
+ *       Models with a scene graph are picked with the node transforms they were loaded with.
+ */
+std::optional<PickResult> Pick(const Model &model, const Ray &ray);
+
+}  // namespace bgl
+
+#endif  // GFX_PICKING_HPP_
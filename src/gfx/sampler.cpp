@@ -0,0 +1,93 @@
+#include <map>
+#include <utility>  // std::exchange()
+
+#include "sampler.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+bool is_supported() noexcept {
+    return GLEW_VERSION_3_3 || GLEW_ARB_sampler_objects;
+}
+
+bool is_anisotropy_supported() noexcept {
+    return GLEW_EXT_texture_filter_anisotropic || GLEW_ARB_texture_filter_anisotropic;
+}
+
+GLfloat get_max_anisotropy() noexcept {
+    GLfloat anisotropy { 1.0f };
+    glGetFloatv(GL_MAX_TEXTURE_MAX_ANISOTROPY_EXT, &anisotropy);
+    return anisotropy;
+}
+
+}  // anonymous namespace
+
+Sampler::Sampler(TextureFilter filter)
+    : _filter { filter } {
+    if (!is_supported()) {
+        return;  // the filtering of the textures themselves applies
+    }
+
+    glGenSamplers(1, &_handle);
+    glSamplerParameteri(_handle, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+    glSamplerParameteri(_handle, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glSamplerParameteri(_handle, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glSamplerParameteri(_handle, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    if (filter == TextureFilter::Anisotropic && is_anisotropy_supported()) {
+        glSamplerParameterf(_handle, GL_TEXTURE_MAX_ANISOTROPY_EXT, get_max_anisotropy());
+    }
+}
+
+Sampler::Sampler(Sampler &&rhs) noexcept
+    : _handle { std::exchange(rhs._handle, 0) },
+      _filter { rhs._filter } {
+}
+
+Sampler& Sampler::operator=(Sampler &&rhs) noexcept {
+    if (this != &rhs) {
+        if (_handle != 0) {
+            glDeleteSamplers(1, &_handle);
+        }
+        _handle = std::exchange(rhs._handle, 0);
+        _filter = rhs._filter;
+    }
+    return *this;
+}
+
+Sampler::~Sampler() noexcept {
+    if (_handle != 0) {
+        glDeleteSamplers(1, &_handle);
+    }
+}
+
+void Sampler::bind(GLuint textureUnit) const {
+    if (_handle != 0) {
+        glBindSampler(textureUnit, _handle);
+    }
+}
+
+void Sampler::release(GLuint textureUnit) const {
+    if (_handle != 0) {
+        glBindSampler(textureUnit, 0);
+    }
+}
+
+TextureFilter Sampler::getFilter() const noexcept {
+    return _filter;
+}
+
+std::shared_ptr<Sampler> GetSampler(TextureFilter filter) {
+    static std::map<TextureFilter, std::weak_ptr<Sampler>> samplers;
+    std::weak_ptr<Sampler> &entry { samplers[filter] };
+
+    std::shared_ptr<Sampler> sampler { entry.lock() };
+    if (!sampler) {
+        sampler = std::make_shared<Sampler>(filter);
+        entry = sampler;
+    }
+    return sampler;
+}
+
+}  // namespace bgl
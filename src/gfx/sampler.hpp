@@ -0,0 +1,54 @@
+/**
+ * @file sampler.hpp
+ * @brief OpenGL sampler objects shared between materials.
+ */
+#ifndef GFX_SAMPLER_HPP_
+#define GFX_SAMPLER_HPP_
+
+#include <memory>
+
+#include "gl.hpp"
+
+
+namespace bgl {
+
+enum class TextureFilter {
+    Trilinear,
+    Anisotropic  // falls back to trilinear without anisotropic filtering support
+};
+
+/**
+ * @brief A non-copyable, but moveable OpenGL sampler object.
+ * @details Overrides the filtering of whatever texture is bound to the same
+ *          texture unit, so textures shared between materials can be sampled differently.
+ */
+class Sampler final {
+ public:
+	explicit Sampler(TextureFilter filter);
+	Sampler(Sampler &&rhs) noexcept;
+	Sampler& operator=(Sampler &&rhs) noexcept;
+
+	Sampler(const Sampler&) = delete;
+	Sampler& operator=(const Sampler&) = delete;
+
+	~Sampler() noexcept;
+
+	void bind(GLuint textureUnit) const;
+	void release(GLuint textureUnit) const;
+
+	TextureFilter getFilter() const noexcept;
+
+ private:
+	GLuint _handle { 0 };  // 0 without sampler object support
+	TextureFilter _filter;
+};
+
+/**
+ * @brief Returns a sampler that is shared by all materials using the same filter.
+ * @note The OpenGL context has to be current.
+ */
+std::shared_ptr<Sampler> GetSampler(TextureFilter filter);
+
+}  // namespace bgl
+
+#endif  // GFX_SAMPLER_HPP_
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "scene.hpp"
+#include "frustum.hpp"
+#include "model.hpp"
+#include "picking.hpp"
+
+
+namespace bgl {
+
+Scene::Id Scene::add(std::shared_ptr<Model> model, const mat4 &transform) {
+    if (!model) {
+        throw std::invalid_argument { "invalid model" };
+    }
+
+    const BoundingBox boundingBox { TransformBoundingBox(model->getBoundingBox(), transform) };
+    _entries.push_back({ _nextId, std::move(model), transform, boundingBox });
+    return _nextId++;
+}
+
+bool Scene::remove(Id id) {
+    const auto it { std::find_if(_entries.begin(), _entries.end(), [id] (const Entry &entry) {
+        return entry.id == id;
+    }) };
+    if (it == _entries.end()) {
+        return false;
+    }
+    _entries.erase(it);
+    return true;
+}
+
+void Scene::clear() noexcept {
+    _entries.clear();
+}
+
+bool Scene::empty() const noexcept {
+    return _entries.empty();
+}
+
+std::size_t Scene::size() const noexcept {
+    return _entries.size();
+}
+
+const std::vector<Scene::Entry>& Scene::getEntries() const noexcept {
+    return _entries;
+}
+
+const Scene::Entry& Scene::get(Id id) const {
+    return const_cast<Scene*>(this)->find(id);
+}
+
+Scene::Entry& Scene::find(Id id) {
+    const auto it { std::find_if(_entries.begin(), _entries.end(), [id] (const Entry &entry) {
+        return entry.id == id;
+    }) };
+    return it != _entries.end() ? *it : throw std::out_of_range { "no model with this id in the scene" };
+}
+
+void Scene::setTransform(Id id, const mat4 &transform) {
+    Entry &entry { find(id) };
+    entry.transform = transform;
+    entry.boundingBox = TransformBoundingBox(entry.model->getBoundingBox(), transform);
+}
+
+BoundingBox Scene::getBoundingBox() const noexcept {
+    if (_entries.empty()) {
+        return BoundingBox { vec3 { 0.0f }, vec3 { 0.0f } };
+    }
+
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (const Entry &entry : _entries) {
+        min = glm::min(min, entry.boundingBox.getMin());
+        max = glm::max(max, entry.boundingBox.getMax());
+    }
+    return BoundingBox { (min + max) / 2.0f, max - min };
+}
+
+std::size_t Scene::render(const mat4 &VP, const DirectionalLight &light) {
+    const Frustum frustum { VP };
+    std::size_t num_drawn { 0 };
+    for (const Entry &entry : _entries) {
+        if (!frustum.intersects(entry.model->getBoundingBox(), entry.transform)) {
+            continue;
+        }
+        entry.model->render(VP * entry.transform, light);
+        ++num_drawn;
+    }
+    return num_drawn;
+}
+
+/**
+ * @details The ray is transformed into the space of each model, the hits are compared in world space.
+ */
+std::optional<Scene::Hit> Scene::pick(const Ray &ray) const {
+    std::optional<Hit> closest;
+    for (const Entry &entry : _entries) {
+        if (!entry.model->getTriangleBvh()) {
+            continue;
+        }
+
+        const mat4 inverse { glm::inverse(entry.transform) };
+        const vec3 origin { inverse * vec4 { ray.origin, 1.0f } };
+        const vec3 direction { glm::normalize(vec3 { inverse * vec4 { ray.direction, 0.0f } }) };
+        const std::optional<PickResult> result { Pick(*entry.model, Ray { origin, direction }) };
+        if (!result) {
+            continue;
+        }
+
+        const vec3 point { entry.transform * vec4 { result->point, 1.0f } };
+        const float distance { glm::length(point - ray.origin) };
+        if (!closest || distance < closest->distance) {
+            closest = Hit { entry.id, result->mesh, result->node, result->triangle, point, distance };
+        }
+    }
+    return closest;
+}
+
+}  // namespace bgl
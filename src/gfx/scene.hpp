@@ -1,17 +1,100 @@
 #ifndef GFX_SCENE_HPP_
 #define GFX_SCENE_HPP_
 
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <vector>
+
 #include "math.hpp"
+#include "bounding_box.hpp"
 
 
 namespace bgl {
 
+class Model;
+struct Ray;
+
 struct DirectionalLight {
     vec3 direction;
     vec3 diffuse;
     vec3 ambient;
 };
 
+/**
+ * @brief Models placed in the world, each with its own transform.
+ * @details Models are shared, not copied: adding a model that is already
+ *          part of the scene draws it a second time with another transform.
+ */
+class Scene final {
+ public:
+    using Id = std::uint32_t;
+
+    /**
+     * @brief A model of the scene and where it is placed.
+     */
+    struct Entry {
+        Id id;
+        std::shared_ptr<Model> model;
+        mat4 transform;
+        BoundingBox boundingBox;  // in world space
+    };
+
+    /**
+     * @brief A picked triangle of a model of the scene.
+     */
+    struct Hit {
+        Id id;
+        std::size_t mesh;      // index into Model::getMeshes()
+        std::uint32_t node;    // see PickResult::node
+        std::size_t triangle;  // within the mesh
+        vec3 point;            // in world space
+        float distance;
+    };
+
+    /**
+     * @return The id the model is referred to by until it is removed.
+     */
+    Id add(std::shared_ptr<Model> model, const mat4 &transform = mat4 { 1.0f });
+
+    /**
+     * @return Whether the model was part of the scene.
+     */
+    bool remove(Id id);
+    void clear() noexcept;
+
+    bool empty() const noexcept;
+    std::size_t size() const noexcept;
+    const std::vector<Entry>& getEntries() const noexcept;
+    const Entry& get(Id id) const;
+
+    void setTransform(Id id, const mat4 &transform);
+
+    /**
+     * @brief Returns the box enclosing all models in world space.
+     */
+    BoundingBox getBoundingBox() const noexcept;
+
+    /**
+     * @brief Draws all models that are at least partially inside the view frustum.
+     * @return The number of drawn models.
+     */
+    std::size_t render(const mat4 &VP, const DirectionalLight &light);
+
+    /**
+     * @brief Returns the closest triangle hit by a ray in world space.
+     * @note Only models imported with ImportOptions::buildTriangleBvh can be picked.
+     */
+    std::optional<Hit> pick(const Ray &ray) const;
+
+ private:
+    Entry& find(Id id);
+
+    std::vector<Entry> _entries;
+    Id _nextId { 0 };
+};
+
 }  // namepace bgl
 
 #endif  // GFX_SCENE_HPP_
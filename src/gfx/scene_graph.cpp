@@ -0,0 +1,125 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "scene_graph.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+const std::vector<std::uint32_t> no_instances;
+
+}  // anonymous namespace
+
+std::uint32_t SceneGraph::addNode(std::uint32_t parent, const mat4 &transform,
+                                  const std::vector<std::uint32_t> &meshes) {
+    const auto node { static_cast<std::uint32_t>(_parents.size()) };
+    if (parent == none ? node != 0 : parent >= node || _ends[parent] != node) {
+        throw std::invalid_argument { "the nodes of a scene graph have to be added in depth first order" };
+    }
+
+    _parents.push_back(parent);
+    _ends.push_back(node + 1);
+    for (std::uint32_t ancestor = parent; ancestor != none; ancestor = _parents[ancestor]) {
+        _ends[ancestor] = node + 1;
+    }
+
+    _transforms.push_back(transform);
+    _worldTransforms.push_back(parent == none ? transform : _worldTransforms[parent] * transform);
+
+    if (_firstMeshes.empty()) {
+        _firstMeshes.push_back(0);
+    }
+    _meshes.insert(_meshes.end(), meshes.begin(), meshes.end());
+    _firstMeshes.push_back(static_cast<std::uint32_t>(_meshes.size()));
+    for (const std::uint32_t mesh : meshes) {
+        if (mesh >= _instances.size()) {
+            _instances.resize(mesh + 1);
+        }
+        _instances[mesh].push_back(node);
+    }
+    return node;
+}
+
+std::size_t SceneGraph::size() const noexcept {
+    return _parents.size();
+}
+
+bool SceneGraph::empty() const noexcept {
+    return _parents.empty();
+}
+
+std::uint32_t SceneGraph::getParent(std::uint32_t node) const {
+    return _parents.at(node);
+}
+
+const mat4& SceneGraph::getTransform(std::uint32_t node) const {
+    return _transforms.at(node);
+}
+
+void SceneGraph::setTransform(std::uint32_t node, const mat4 &transform) {
+    _transforms.at(node) = transform;
+    _dirty.push_back(node);
+}
+
+const mat4& SceneGraph::getWorldTransform(std::uint32_t node) const {
+    return _worldTransforms.at(node);
+}
+
+/**
+ * @details Parents precede their children, so one pass over the range of a
+ *          dirty subtree sees each parent updated before its children.
+ */
+std::size_t SceneGraph::update() {
+    std::sort(_dirty.begin(), _dirty.end());
+
+    std::size_t num_updated { 0 };
+    std::uint32_t updated_end { 0 };  // of the last updated subtree
+    for (const std::uint32_t root : _dirty) {
+        if (root < updated_end) {
+            continue;  // within a subtree that was already updated
+        }
+
+        for (std::uint32_t node = root; node < _ends[root]; ++node) {
+            const std::uint32_t parent { _parents[node] };
+            _worldTransforms[node] = parent == none ? _transforms[node]
+                                                    : _worldTransforms[parent] * _transforms[node];
+        }
+        num_updated += _ends[root] - root;
+        updated_end = _ends[root];
+    }
+
+    _dirty.clear();
+    return num_updated;
+}
+
+std::vector<std::uint32_t> SceneGraph::getMeshes(std::uint32_t node) const {
+    if (node >= size()) {
+        throw std::out_of_range { "invalid scene graph node" };
+    }
+    return { _meshes.begin() + _firstMeshes[node], _meshes.begin() + _firstMeshes[node + 1] };
+}
+
+const std::vector<std::uint32_t>& SceneGraph::getInstances(std::uint32_t mesh) const {
+    return mesh < _instances.size() ? _instances[mesh] : no_instances;
+}
+
+BoundingBox SceneGraph::getBoundingBox(const std::vector<BoundingBox> &meshBoxes) const {
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    for (std::uint32_t mesh = 0; mesh < meshBoxes.size(); ++mesh) {
+        for (const std::uint32_t node : getInstances(mesh)) {
+            const BoundingBox box { TransformBoundingBox(meshBoxes[mesh], _worldTransforms[node]) };
+            min = glm::min(min, box.getMin());
+            max = glm::max(max, box.getMax());
+        }
+    }
+
+    const vec3 size { max - min };
+    const vec3 center { min + (size / 2.0f) };
+    return BoundingBox { center, size };
+}
+
+}  // namespace bgl
@@ -0,0 +1,89 @@
+/**
+ * @file scene_graph.hpp
+ * @brief A transform hierarchy whose nodes share the meshes of a model.
+ */
+#ifndef GFX_SCENE_GRAPH_HPP_
+#define GFX_SCENE_GRAPH_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "math.hpp"
+#include "bounding_box.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief The node hierarchy of an imported scene with one world transform per node.
+ * @details The nodes are stored in depth first order, so the subtree of a
+ *          node is the range of nodes directly following it. Each property
+ *          lives in its own flat array indexed by node. Meshes are referred
+ *          to by index and can be shared by any number of nodes.
+ */
+class SceneGraph final {
+ public:
+	static constexpr std::uint32_t none { ~0u };  // the parent of the root
+
+	/**
+	 * @brief Appends a node, a parent has to be followed by its whole subtree.
+	 * @param parent A node added before, or none for the root.
+	 * @param transform Relative to the parent.
+	 * @param meshes Indices of the meshes the node draws.
+	 * @return The index of the new node.
+	 */
+	std::uint32_t addNode(std::uint32_t parent, const mat4 &transform, const std::vector<std::uint32_t> &meshes);
+
+	std::size_t size() const noexcept;
+	bool empty() const noexcept;
+
+	std::uint32_t getParent(std::uint32_t node) const;
+	const mat4& getTransform(std::uint32_t node) const;
+
+	/**
+	 * @brief Sets the transform of a node relative to its parent and marks its subtree dirty.
+	 */
+	void setTransform(std::uint32_t node, const mat4 &transform);
+
+	/**
+	 * @brief Returns the world transform of a node as of the last update().
+	 */
+	const mat4& getWorldTransform(std::uint32_t node) const;
+
+	/**
+	 * @brief Recomputes the world transforms of all dirty subtrees.
+	 * @return The number of recomputed nodes.
+	 */
+	std::size_t update();
+
+	/**
+	 * @brief Returns the indices of the meshes a node draws.
+	 */
+	std::vector<std::uint32_t> getMeshes(std::uint32_t node) const;
+
+	/**
+	 * @brief Returns the nodes that draw a mesh.
+	 */
+	const std::vector<std::uint32_t>& getInstances(std::uint32_t mesh) const;
+
+	/**
+	 * @brief Returns the box enclosing all instances of the meshes in world space.
+	 * @param meshBoxes The bounding boxes of the meshes.
+	 */
+	BoundingBox getBoundingBox(const std::vector<BoundingBox> &meshBoxes) const;
+
+ private:
+	std::vector<std::uint32_t> _parents;
+	std::vector<std::uint32_t> _ends;        // one past the last node of each subtree
+	std::vector<mat4> _transforms;           // relative to the parent
+	std::vector<mat4> _worldTransforms;
+	std::vector<std::uint32_t> _firstMeshes;  // into _meshes, one more than there are nodes
+	std::vector<std::uint32_t> _meshes;
+	std::vector<std::vector<std::uint32_t>> _instances;  // nodes per mesh
+	std::vector<std::uint32_t> _dirty;        // nodes whose transform changed since the last update()
+};
+
+}  // namespace bgl
+
+#endif  // GFX_SCENE_GRAPH_HPP_
@@ -0,0 +1,143 @@
+#include "gl.hpp"
+
+#include <stdexcept>
+
+#include "state_tracker.hpp"
+#include "sampler.hpp"
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLTexture>
+#include <QOpenGLVertexArrayObject>
+
+
+namespace bgl {
+
+StateTracker& StateTracker::instance() {
+    static StateTracker tracker;
+    return tracker;
+}
+
+void StateTracker::beginFrame() noexcept {
+    _frameStats = _stats;
+    _stats = {};
+}
+
+const RenderStats& StateTracker::getFrameStats() const noexcept {
+    return _frameStats;
+}
+
+void StateTracker::invalidate() noexcept {
+    _program = nullptr;
+    _textureUnits.fill({});
+    _isActiveTextureUnitKnown = false;
+    _vertexArray = nullptr;
+    _isMaterialKnown = false;
+    _isVertexFormatKnown = false;
+}
+
+bool StateTracker::bindProgram(QOpenGLShaderProgram &program) {
+    if (_program == &program) {
+        ++_stats.skippedChanges;
+        return false;
+    }
+
+    program.bind();
+    _program = &program;
+    _isMaterialKnown = false;  // uniforms are per program
+    _isVertexFormatKnown = false;
+    ++_stats.programBinds;
+    return true;
+}
+
+void StateTracker::bindTexture(GLuint textureUnit, QOpenGLTexture &texture, const Sampler *sampler) {
+    if (textureUnit >= max_texture_units) {
+        throw std::out_of_range { "texture unit out of range" };
+    }
+
+    TextureUnit &unit { _textureUnits[textureUnit] };
+    if (unit.texture != &texture) {
+        if (!_isActiveTextureUnitKnown || _activeTextureUnit != textureUnit) {
+            glActiveTexture(GL_TEXTURE0 + textureUnit);
+            _activeTextureUnit = textureUnit;
+            _isActiveTextureUnitKnown = true;
+        }
+        texture.bind();
+        unit.texture = &texture;
+        ++_stats.textureBinds;
+    } else {
+        ++_stats.skippedChanges;
+    }
+
+    if (unit.sampler != sampler) {
+        if (sampler) {
+            sampler->bind(textureUnit);
+        } else if (unit.sampler) {
+            unit.sampler->release(textureUnit);
+        }
+        unit.sampler = sampler;
+        ++_stats.samplerBinds;
+    } else {
+        ++_stats.skippedChanges;
+    }
+}
+
+void StateTracker::bindVertexArray(QOpenGLVertexArrayObject &vao) {
+    if (_vertexArray == &vao) {
+        ++_stats.skippedChanges;
+        return;
+    }
+
+    vao.bind();
+    _vertexArray = &vao;
+    ++_stats.vertexArrayBinds;
+}
+
+void StateTracker::releaseVertexArray() {
+    if (_vertexArray) {
+        _vertexArray->release();
+        _vertexArray = nullptr;
+    }
+}
+
+bool StateTracker::setMaterial(const Material *material) noexcept {
+    if (_isMaterialKnown && _material == material) {
+        ++_stats.skippedChanges;
+        return false;
+    }
+
+    _material = material;
+    _isMaterialKnown = true;
+    ++_stats.materialChanges;
+    return true;
+}
+
+bool StateTracker::setVertexFormat(VertexFormat format, const VertexQuantization &quantization) noexcept {
+    if (_isVertexFormatKnown && _vertexFormat == format &&
+        _quantization.offset == quantization.offset && _quantization.scale == quantization.scale &&
+        _quantization.texcoordOffset == quantization.texcoordOffset &&
+        _quantization.texcoordScale == quantization.texcoordScale) {
+        ++_stats.skippedChanges;
+        return false;
+    }
+
+    _vertexFormat = format;
+    _quantization = quantization;
+    _isVertexFormatKnown = true;
+    ++_stats.vertexFormatChanges;
+    return true;
+}
+
+void StateTracker::countUniformUpdates(std::size_t count) noexcept {
+    _stats.uniformUpdates += count;
+}
+
+void StateTracker::countDrawCall() noexcept {
+    ++_stats.drawCalls;
+}
+
+void StateTracker::countCulling(std::size_t visible, std::size_t culled) noexcept {
+    _stats.visibleMeshes += visible;
+    _stats.culledMeshes += culled;
+}
+
+}  // namespace bgl
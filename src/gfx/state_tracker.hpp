@@ -0,0 +1,128 @@
+/**
+ * @file state_tracker.hpp
+ * @brief Elimination of redundant OpenGL state changes.
+ */
+#ifndef GFX_STATE_TRACKER_HPP_
+#define GFX_STATE_TRACKER_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "gl.hpp"
+#include "vertex_format.hpp"
+
+class QOpenGLShaderProgram;
+class QOpenGLTexture;
+class QOpenGLVertexArrayObject;
+
+
+namespace bgl {
+
+class Sampler;
+struct Material;
+
+/**
+ * @brief State changes of one frame.
+ */
+struct RenderStats {
+    std::size_t drawCalls { 0 };
+    std::size_t programBinds { 0 };
+    std::size_t textureBinds { 0 };
+    std::size_t samplerBinds { 0 };
+    std::size_t vertexArrayBinds { 0 };
+    std::size_t materialChanges { 0 };
+    std::size_t vertexFormatChanges { 0 };
+    std::size_t uniformUpdates { 0 };
+    std::size_t skippedChanges { 0 };  // redundant changes that were not sent to OpenGL
+    std::size_t visibleMeshes { 0 };
+    std::size_t culledMeshes { 0 };    // outside the view frustum
+};
+
+/**
+ * @brief Remembers the currently bound OpenGL state and skips changes that would not change anything.
+ * @details State that is changed behind the tracker's back (e.g. by
+ *          QOpenGLShaderProgram::bind()) has to be announced with invalidate().
+ * @note Must only be used on the thread of the OpenGL context.
+ */
+class StateTracker final {
+ public:
+	StateTracker() = default;
+
+	StateTracker(const StateTracker&) = delete;
+	StateTracker& operator=(const StateTracker&) = delete;
+
+	/**
+	 * @brief Returns the tracker of the OpenGL context.
+	 */
+	static StateTracker& instance();
+
+	/**
+	 * @brief Finishes the statistics of the last frame and starts new ones.
+	 */
+	void beginFrame() noexcept;
+
+	/**
+	 * @brief Returns the statistics of the last complete frame.
+	 */
+	const RenderStats& getFrameStats() const noexcept;
+
+	/**
+	 * @brief Forgets all bound state.
+	 */
+	void invalidate() noexcept;
+
+	/**
+	 * @return Whether @p program was not bound yet and its uniforms have to be set.
+	 */
+	bool bindProgram(QOpenGLShaderProgram &program);
+	void bindTexture(GLuint textureUnit, QOpenGLTexture &texture, const Sampler *sampler);
+
+	/**
+	 * @brief Binds a VAO that other objects do not expect to remain bound.
+	 * @details It has to be unbound with releaseVertexArray() before others draw.
+	 */
+	void bindVertexArray(QOpenGLVertexArrayObject &vao);
+	void releaseVertexArray();
+
+	/**
+	 * @return Whether @p material differs from the current material and its uniforms have to be set.
+	 */
+	bool setMaterial(const Material *material) noexcept;
+
+	/**
+	 * @return Whether the vertex format differs from the current one and its uniforms have to be set.
+	 */
+	bool setVertexFormat(VertexFormat format, const VertexQuantization &quantization) noexcept;
+
+	void countUniformUpdates(std::size_t count) noexcept;
+	void countDrawCall() noexcept;
+	void countCulling(std::size_t visible, std::size_t culled) noexcept;
+
+ private:
+	static constexpr std::size_t max_texture_units { 16 };
+
+	struct TextureUnit {
+		QOpenGLTexture *texture { nullptr };
+		const Sampler *sampler { nullptr };
+	};
+
+	QOpenGLShaderProgram *_program { nullptr };
+	std::array<TextureUnit, max_texture_units> _textureUnits {};
+	GLuint _activeTextureUnit { 0 };
+	bool _isActiveTextureUnitKnown { false };
+	QOpenGLVertexArrayObject *_vertexArray { nullptr };
+
+	const Material *_material { nullptr };
+	bool _isMaterialKnown { false };
+
+	VertexFormat _vertexFormat { VertexFormat::Float };
+	VertexQuantization _quantization;
+	bool _isVertexFormatKnown { false };
+
+	RenderStats _stats;
+	RenderStats _frameStats;
+};
+
+}  // namespace bgl
+
+#endif  // GFX_STATE_TRACKER_HPP_
@@ -0,0 +1,166 @@
+#include <algorithm>
+#include <cstring>  // std::memcpy()
+#include <iostream>
+#include <stdexcept>
+
+#include "stream_buffer.hpp"
+
+#include <QOpenGLContext>  // NOLINT
+
+
+namespace bgl {
+
+namespace {
+
+constexpr std::size_t region_alignment { 4096 };  // a multiple of all buffer offset alignments
+constexpr GLuint64 wait_timeout { 1000000 };     // [ns]
+
+constexpr std::size_t align(std::size_t offset, std::size_t alignment) noexcept {
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+bool is_persistent_mapping_supported() noexcept {
+    return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+}
+
+}  // anonymous namespace
+
+StreamBuffer::StreamBuffer(std::size_t regionSize) noexcept
+    : _regionSize { align(regionSize, region_alignment) } {
+}
+
+StreamBuffer::~StreamBuffer() noexcept {
+    if (QOpenGLContext::currentContext()) {
+        destroy();
+    }
+}
+
+StreamBuffer& StreamBuffer::instance() {
+    static StreamBuffer buffer;
+    return buffer;
+}
+
+void StreamBuffer::create(std::size_t regionSize) {
+    _regionSize = align(regionSize, region_alignment);
+    const auto size { static_cast<GLsizeiptr>(_regionSize * num_regions) };
+
+    // GL_COPY_WRITE_BUFFER leaves the bindings of vertex, index and uniform buffers alone
+    glGenBuffers(1, &_handle);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+    if (is_persistent_mapping_supported()) {
+        const GLbitfield flags { GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT };
+        glBufferStorage(GL_COPY_WRITE_BUFFER, size, nullptr, flags);
+        _mapping = static_cast<std::byte*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, 0, size, flags));
+        if (!_mapping) {
+            glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+            destroy();
+            throw std::runtime_error { "could not map stream buffer" };
+        }
+    } else {
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    }
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+}
+
+void StreamBuffer::destroy() noexcept {
+    for (GLsync &fence : _fences) {
+        if (fence) {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+    if (_handle != 0) {
+        glDeleteBuffers(1, &_handle);  // unmaps it
+        _handle = 0;
+        _mapping = nullptr;
+    }
+}
+
+void StreamBuffer::wait(std::size_t region) {
+    GLsync &fence { _fences[region] };
+    if (!fence) {
+        return;
+    }
+
+    GLenum result { glClientWaitSync(fence, 0, 0) };
+    if (result == GL_TIMEOUT_EXPIRED) {
+        ++_stats.fenceWaits;
+        do {
+            result = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, wait_timeout);
+        } while (result == GL_TIMEOUT_EXPIRED);
+    }
+
+    glDeleteSync(fence);
+    fence = nullptr;
+    if (result == GL_WAIT_FAILED) {
+        throw std::runtime_error { "glClientWaitSync() failed" };
+    }
+}
+
+void StreamBuffer::beginFrame() {
+    if (_handle != 0) {
+        _fences[_region] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        _region = (_region + 1) % num_regions;
+    }
+
+    _frameStats = _stats;
+    _stats = {};
+    _requiredSize = std::max(_requiredSize, _demand);
+    _demand = 0;
+    _offset = 0;
+    ++_frame;
+
+    if (_handle != 0 && _requiredSize > _regionSize) {
+        for (auto i = 0u; i < num_regions; ++i) {
+            wait(i);  // the GPU may still read any of them
+        }
+        destroy();
+        _region = 0;
+        std::cout << "growing stream buffer regions to " << align(_requiredSize, region_alignment) / 1024
+                  << " KiB" << std::endl;
+    }
+    if (_handle == 0) {
+        create(std::max(_regionSize, _requiredSize));
+    }
+    wait(_region);
+}
+
+std::optional<StreamAllocation> StreamBuffer::write(const void *data, std::size_t size, std::size_t alignment) {
+    if (_handle == 0) {
+        create(_regionSize);
+    }
+
+    _demand = align(_demand, alignment) + size;
+    const std::size_t offset { align(_offset, alignment) };
+    if (offset + size > _regionSize) {
+        ++_stats.overflows;
+        return {};
+    }
+
+    const std::size_t buffer_offset { _region * _regionSize + offset };
+    if (_mapping) {
+        std::memcpy(_mapping + buffer_offset, data, size);
+    } else {
+        glBindBuffer(GL_COPY_WRITE_BUFFER, _handle);
+        glBufferSubData(GL_COPY_WRITE_BUFFER, buffer_offset, size, data);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    }
+
+    _offset = offset + size;
+    _stats.bytesStreamed += size;
+    return StreamAllocation { _handle, buffer_offset };
+}
+
+std::size_t StreamBuffer::getFrame() const noexcept {
+    return _frame;
+}
+
+const StreamStats& StreamBuffer::getFrameStats() const noexcept {
+    return _frameStats;
+}
+
+bool StreamBuffer::isPersistent() const noexcept {
+    return _mapping != nullptr;
+}
+
+}  // namespace bgl
@@ -0,0 +1,106 @@
+/**
+ * @file stream_buffer.hpp
+ * @brief A persistently mapped ring buffer for data that changes every frame.
+ */
+#ifndef GFX_STREAM_BUFFER_HPP_
+#define GFX_STREAM_BUFFER_HPP_
+
+#include <array>
+#include <cstddef>
+#include <optional>
+
+#include "gl.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Streaming of one frame.
+ */
+struct StreamStats {
+    std::size_t bytesStreamed { 0 };
+    std::size_t fenceWaits { 0 };  // frames that had to wait for the GPU to release their region
+    std::size_t overflows { 0 };   // writes that did not fit and were left to the caller
+};
+
+/**
+ * @brief Location of streamed data.
+ */
+struct StreamAllocation {
+    GLuint buffer;
+    std::size_t offset;  // in bytes
+};
+
+/**
+ * @brief A ring of one region per frame in flight within a single buffer object.
+ * @details With OpenGL 4.4 or ARB_buffer_storage the buffer is mapped once
+ *          (GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT) and written with
+ *          memcpy(), otherwise with glBufferSubData(). Each region is fenced
+ *          with glFenceSync() when its frame ends and only reused once the GPU
+ *          passed the fence. Frames that need more space than a region has
+ *          grow the buffer at the beginning of the next frame.
+ * @note Must only be used on the thread of the OpenGL context.
+ */
+class StreamBuffer final {
+ public:
+	static constexpr std::size_t num_regions { 3 };  // triple buffering
+	static constexpr std::size_t default_region_size { 4 * 1024 * 1024 };
+
+	explicit StreamBuffer(std::size_t regionSize = default_region_size) noexcept;
+
+	StreamBuffer(const StreamBuffer&) = delete;
+	StreamBuffer& operator=(const StreamBuffer&) = delete;
+
+	~StreamBuffer() noexcept;
+
+	/**
+	 * @brief Returns the stream buffer of the OpenGL context.
+	 */
+	static StreamBuffer& instance();
+
+	/**
+	 * @brief Fences the region of the last frame and moves on to the next one.
+	 * @details Waits if the GPU still reads the next region.
+	 */
+	void beginFrame();
+
+	/**
+	 * @brief Copies @p data into the region of the current frame.
+	 * @return The location of the copy or nothing if the region is full.
+	 */
+	std::optional<StreamAllocation> write(const void *data, std::size_t size, std::size_t alignment = 16);
+
+	/**
+	 * @brief Returns a number that changes with each beginFrame().
+	 */
+	std::size_t getFrame() const noexcept;
+
+	/**
+	 * @brief Returns the statistics of the last complete frame.
+	 */
+	const StreamStats& getFrameStats() const noexcept;
+
+	bool isPersistent() const noexcept;
+
+ private:
+	void create(std::size_t regionSize);
+	void destroy() noexcept;
+	void wait(std::size_t region);
+
+	GLuint _handle { 0 };
+	std::byte *_mapping { nullptr };  // of the whole buffer, nullptr without persistent mapping
+	std::size_t _regionSize;
+	std::size_t _region { 0 };        // of the current frame
+	std::size_t _offset { 0 };        // within the region
+	std::size_t _demand { 0 };        // bytes the current frame asked for
+	std::size_t _requiredSize { 0 };  // by the largest frame so far
+	std::array<GLsync, num_regions> _fences {};
+	std::size_t _frame { 0 };
+
+	StreamStats _stats;
+	StreamStats _frameStats;
+};
+
+}  // namespace bgl
+
+#endif  // GFX_STREAM_BUFFER_HPP_
@@ -0,0 +1,164 @@
+#include "gl.hpp"
+
+#include <iostream>
+
+#include "texture_cache.hpp"
+#include "thread_pool.hpp"
+
+#include <QImage>
+#include <QOpenGLTexture>
+
+
+namespace bgl {
+
+namespace {
+
+QImage decode_image(const std::filesystem::path &path) {
+    std::cout << "loading " << path << std::endl;
+    QImage image { path.string().c_str() };
+    if (image.isNull()) {
+        std::cout << "warning: could not load " << path << std::endl;
+    }
+    return image;
+}
+
+bool is_up_to_date(const std::filesystem::path &compressed_path, const std::filesystem::path &path) {
+    std::error_code error;
+    const auto compressed_time { std::filesystem::last_write_time(compressed_path, error) };
+    return !error && compressed_time >= std::filesystem::last_write_time(path);
+}
+
+TextureData decode_texture(const std::filesystem::path &path, const TextureOptions &options) {
+    const std::filesystem::path compressed_path { GetCompressedPath(path, options.mipFilter) };
+    if (options.compress && is_up_to_date(compressed_path, path)) {
+        std::optional<CompressedImage> compressed { LoadDDS(compressed_path) };
+        if (compressed.has_value()) {
+            std::cout << "loading " << compressed_path << std::endl;
+            return { {}, std::move(compressed) };
+        }
+    }
+
+    const QImage image { decode_image(path) };
+    if (image.isNull()) {
+        return {};
+    }
+
+    std::vector<MipLevel> levels { GenerateMipChain(image, options.mipFilter) };
+    if (!options.compress) {
+        return { std::move(levels), {} };
+    }
+
+    CompressedImage compressed { CompressImage(levels) };
+    try {
+        SaveDDS(compressed_path, compressed);
+    } catch (const std::exception &exception) {
+        std::cout << "warning: could not write " << compressed_path << ": " << exception.what() << std::endl;
+    }
+    return { {}, std::move(compressed) };
+}
+
+bool is_compression_supported() noexcept {
+    return GLEW_EXT_texture_compression_s3tc;
+}
+
+std::shared_ptr<QOpenGLTexture> create_texture(const CompressedImage &image) {
+    const auto texture { std::make_shared<QOpenGLTexture>(QOpenGLTexture::Target2D) };
+    texture->setFormat(image.format == BlockFormat::BC1 ? QOpenGLTexture::RGB_DXT1
+                                                        : QOpenGLTexture::RGBA_DXT5);
+    texture->setSize(image.width, image.height);
+    texture->setMipLevels(static_cast<int>(image.levels.size()));
+    texture->allocateStorage();
+
+    // precomputed mip chain, no glGenerateMipmap()
+    for (auto level = 0u; level < image.levels.size(); ++level) {
+        texture->setCompressedData(level, static_cast<int>(image.levels[level].size()), image.levels[level].data());
+    }
+    texture->setMinMagFilters(QOpenGLTexture::LinearMipMapLinear, QOpenGLTexture::Linear);
+    return texture;
+}
+
+std::shared_ptr<QOpenGLTexture> create_texture(const std::vector<MipLevel> &levels) {
+    const auto texture { std::make_shared<QOpenGLTexture>(QOpenGLTexture::Target2D) };
+    texture->setFormat(QOpenGLTexture::RGBA8_UNorm);
+    texture->setSize(levels.front().width, levels.front().height);
+    texture->setMipLevels(static_cast<int>(levels.size()));
+    texture->allocateStorage(QOpenGLTexture::RGBA, QOpenGLTexture::UInt8);
+
+    for (auto level = 0u; level < levels.size(); ++level) {
+        texture->setData(level, QOpenGLTexture::RGBA, QOpenGLTexture::UInt8, levels[level].texels.data());
+    }
+    texture->setMinMagFilters(QOpenGLTexture::LinearMipMapLinear, QOpenGLTexture::Linear);
+    return texture;
+}
+
+std::shared_ptr<QOpenGLTexture> create_texture(const TextureData &data) {
+    if (data.compressed.has_value()) {
+        return create_texture(data.compressed.value());
+    }
+    if (!data.levels.empty()) {
+        return create_texture(data.levels);
+    }
+    return {};
+}
+
+}  // anonymous namespace
+
+TextureCache& TextureCache::instance() {
+    static TextureCache cache;
+    return cache;
+}
+
+PendingTexture TextureCache::prefetch(const std::filesystem::path &path, const TextureOptions &options) {
+    const std::filesystem::path key { path.lexically_normal() };
+    TextureOptions supported_options { options };
+    supported_options.compress = options.compress && is_compression_supported();
+    std::lock_guard<std::mutex> lock { _mutex };
+
+    const auto texture { _textures.find(key) };
+    if ((texture != _textures.end() && !texture->second.expired()) || _failed.count(key) != 0) {
+        return {};
+    }
+
+    std::weak_ptr<const std::shared_future<TextureData>> &entry { _images[key] };
+    PendingTexture image { entry.lock() };
+    if (!image) {
+        image = std::make_shared<const std::shared_future<TextureData>>(
+            ThreadPool::instance().submit([key, supported_options] () {
+                return decode_texture(key, supported_options);
+            }).share());
+        entry = image;
+    }
+    return image;
+}
+
+std::shared_ptr<QOpenGLTexture> TextureCache::get(const std::filesystem::path &path,
+                                                  const TextureOptions &options) {
+    const std::filesystem::path key { path.lexically_normal() };
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+        if (auto texture { _textures[key].lock() }) {
+            return texture;
+        }
+        if (_failed.count(key) != 0) {
+            return {};
+        }
+    }
+
+    const PendingTexture image { prefetch(key, options) };
+    if (!image) {
+        return get(key, options);  // uploaded or failed in another thread in the meantime
+    }
+
+    const std::shared_ptr<QOpenGLTexture> texture { create_texture(image->get()) };  // waits for the decoding
+
+    std::lock_guard<std::mutex> lock { _mutex };
+    _images.erase(key);  // the texture holds the pixels from now on
+    if (texture) {
+        _textures[key] = texture;
+    } else {
+        _failed.insert(key);
+    }
+    return texture;
+}
+
+}  // namespace bgl
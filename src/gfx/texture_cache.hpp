@@ -0,0 +1,94 @@
+/**
+ * @file texture_cache.hpp
+ * @brief Shared, path keyed OpenGL textures.
+ */
+#ifndef GFX_TEXTURE_CACHE_HPP_
+#define GFX_TEXTURE_CACHE_HPP_
+
+#include <filesystem>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <vector>
+
+#include "mipmap.hpp"
+#include "texture_compression.hpp"
+
+class QOpenGLTexture;
+
+
+namespace bgl {
+
+/**
+ * @brief How images are turned into textures.
+ */
+struct TextureOptions {
+	bool compress { false };                // block compress if supported
+	MipFilter mipFilter { MipFilter::Box };
+};
+
+/**
+ * @brief A decoded image with its mip chain that is ready to be uploaded.
+ */
+struct TextureData {
+	std::vector<MipLevel> levels;               // uncompressed fallback
+	std::optional<CompressedImage> compressed;
+};
+
+/**
+ * @brief An image that is being decoded, it is kept as long as a handle to it exists.
+ */
+using PendingTexture = std::shared_ptr<const std::shared_future<TextureData>>;
+
+/**
+ * @brief Hands out one texture per image file to all materials that use it.
+ * @details Images are decoded on the ThreadPool, only the upload happens on
+ *          the thread of the OpenGL context. The cache does not keep textures
+ *          or decoded images alive on its own. Images that cannot be decoded
+ *          are remembered and not tried again.
+ */
+class TextureCache final {
+ public:
+	TextureCache() = default;
+
+	TextureCache(const TextureCache&) = delete;
+	TextureCache& operator=(const TextureCache&) = delete;
+
+	/**
+	 * @brief Returns the process wide cache.
+	 */
+	static TextureCache& instance();
+
+	/**
+	 * @brief Starts decoding an image unless its texture is alive or it is already being decoded.
+	 * @details The mip chain is generated along with the decoding, so no
+	 *          glGenerateMipmap() is needed. With TextureOptions::compress, the
+	 *          image is block compressed once and the result is kept in a DDS
+	 *          file next to it (see GetCompressedPath()). Without support for
+	 *          S3TC textures, the image is left uncompressed.
+	 * @return The pending image that has to be held until get() is called for it,
+	 *         or nullptr if the texture is alive or the image could not be decoded before.
+	 * @note Can be called from any thread once OpenGL has been initialized.
+	 */
+	PendingTexture prefetch(const std::filesystem::path &path, const TextureOptions &options = {});
+
+	/**
+	 * @brief Returns the texture of an image file, decoding and uploading it if needed.
+	 * @return The texture or nullptr if the image could not be decoded.
+	 * @note The OpenGL context has to be current.
+	 */
+	std::shared_ptr<QOpenGLTexture> get(const std::filesystem::path &path, const TextureOptions &options = {});
+
+ private:
+	std::mutex _mutex;
+	std::map<std::filesystem::path, std::weak_ptr<const std::shared_future<TextureData>>> _images;  // not uploaded
+	std::map<std::filesystem::path, std::weak_ptr<QOpenGLTexture>> _textures;
+	std::set<std::filesystem::path> _failed;  // images that could not be decoded
+};
+
+}  // namespace bgl
+
+#endif  // GFX_TEXTURE_CACHE_HPP_
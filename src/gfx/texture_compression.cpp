@@ -0,0 +1,418 @@
+#include <algorithm>
+#include <array>
+#include <cstring>   // std::memcpy()
+#include <fstream>
+#include <limits>
+#include <stdexcept>
+
+#include "texture_compression.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+using rgba = MipLevel::rgba;
+using block = std::array<rgba, 16>;  // 4x4 texels, row by row
+
+/*********************************************************
+ *                    Block Encoding Code                *
+ *********************************************************/
+inline unsigned quantize(unsigned value, unsigned max) noexcept {
+    return (value * max + 127) / 255;  // rounded
+}
+
+inline std::uint16_t to_565(const rgba &color) noexcept {
+    return static_cast<std::uint16_t>((quantize(color[0], 31) << 11) | (quantize(color[1], 63) << 5) |
+                                      quantize(color[2], 31));
+}
+
+inline rgba from_565(std::uint16_t color) noexcept {
+    const unsigned r { (color >> 11) & 0x1Fu };
+    const unsigned g { (color >> 5) & 0x3Fu };
+    const unsigned b { color & 0x1Fu };
+    return {
+        static_cast<std::uint8_t>((r << 3) | (r >> 2)),
+        static_cast<std::uint8_t>((g << 2) | (g >> 4)),
+        static_cast<std::uint8_t>((b << 3) | (b >> 2)),
+        255
+    };
+}
+
+inline std::uint8_t mix(unsigned a, unsigned b, unsigned weight_a, unsigned weight_b) noexcept {
+    return static_cast<std::uint8_t>((a * weight_a + b * weight_b) / (weight_a + weight_b));
+}
+
+template<std::size_t N>
+std::size_t find_nearest(const std::array<rgba, N> &palette, const rgba &color, int num_channels) noexcept {
+    std::size_t nearest { 0 };
+    int nearest_distance { std::numeric_limits<int>::max() };
+    for (std::size_t i = 0; i < N; ++i) {
+        int distance { 0 };
+        for (int c = 0; c < num_channels; ++c) {
+            const int d { palette[i][c] - color[c] };
+            distance += d * d;
+        }
+        if (distance < nearest_distance) {
+            nearest = i;
+            nearest_distance = distance;
+        }
+    }
+    return nearest;
+}
+
+/**
+ * @brief Flips the bounding box so that its diagonal follows the colors of the block.
+ * @details The endpoints are min and max of each channel, which only fits colors
+ *          that rise together. A channel that falls while the widest channel
+ *          rises gets its min and max swapped.
+ */
+void select_diagonal(const block &texels, rgba &min, rgba &max) noexcept {
+    int widest { 0 };
+    for (int c = 1; c < 3; ++c) {
+        if (max[c] - min[c] > max[widest] - min[widest]) {
+            widest = c;
+        }
+    }
+
+    std::array<int, 3> center;
+    for (int c = 0; c < 3; ++c) {
+        center[c] = (min[c] + max[c]) / 2;
+    }
+
+    for (int c = 0; c < 3; ++c) {
+        int covariance { 0 };
+        for (const rgba &texel : texels) {
+            covariance += (texel[widest] - center[widest]) * (texel[c] - center[c]);
+        }
+        if (covariance < 0) {
+            std::swap(min[c], max[c]);
+        }
+    }
+}
+
+/**
+ * @brief Encodes the colors of a block as BC1 color block with bounding box endpoints.
+ * @see J.M.P. van Waveren, "Real-Time DXT Compression", 2006
+ */
+void encode_color_block(const block &texels, std::byte *output) {
+    rgba min { 255, 255, 255, 255 };
+    rgba max { 0, 0, 0, 255 };
+    for (const rgba &texel : texels) {
+        for (int c = 0; c < 3; ++c) {
+            min[c] = std::min(min[c], texel[c]);
+            max[c] = std::max(max[c], texel[c]);
+        }
+    }
+
+    select_diagonal(texels, min, max);
+
+    // insets the bounding box to reduce the error of the interpolated colors
+    for (int c = 0; c < 3; ++c) {
+        const int inset { (max[c] - min[c]) / 16 };  // negative for flipped channels
+        min[c] = static_cast<std::uint8_t>(min[c] + inset);
+        max[c] = static_cast<std::uint8_t>(max[c] - inset);
+    }
+
+    std::uint16_t color0 { to_565(max) };
+    std::uint16_t color1 { to_565(min) };
+    std::uint32_t indices { 0 };
+
+    if (color0 != color1) {
+        if (color0 < color1) {
+            std::swap(color0, color1);  // color0 > color1 selects the 4 color mode
+        }
+
+        const rgba c0 { from_565(color0) };
+        const rgba c1 { from_565(color1) };
+        const std::array<rgba, 4> palette {{
+            c0, c1,
+            { mix(c0[0], c1[0], 2, 1), mix(c0[1], c1[1], 2, 1), mix(c0[2], c1[2], 2, 1), 255 },
+            { mix(c0[0], c1[0], 1, 2), mix(c0[1], c1[1], 1, 2), mix(c0[2], c1[2], 1, 2), 255 }
+        }};
+
+        for (std::size_t i = 0; i < texels.size(); ++i) {
+            indices |= static_cast<std::uint32_t>(find_nearest(palette, texels[i], 3)) << (2 * i);
+        }
+    }
+
+    std::memcpy(output, &color0, 2);
+    std::memcpy(output + 2, &color1, 2);
+    std::memcpy(output + 4, &indices, 4);
+}
+
+/**
+ * @brief Encodes the alpha channel of a block as BC3 alpha block.
+ */
+void encode_alpha_block(const block &texels, std::byte *output) {
+    std::uint8_t alpha0 { 0 };
+    std::uint8_t alpha1 { 255 };
+    for (const rgba &texel : texels) {
+        alpha0 = std::max(alpha0, texel[3]);
+        alpha1 = std::min(alpha1, texel[3]);
+    }
+
+    std::uint64_t indices { 0 };
+    if (alpha0 != alpha1) {
+        // alpha0 > alpha1 selects 6 interpolated values
+        std::array<rgba, 8> palette {};
+        palette[0][3] = alpha0;
+        palette[1][3] = alpha1;
+        for (unsigned i = 1; i < 7; ++i) {
+            palette[i + 1][3] = mix(alpha0, alpha1, 7 - i, i);
+        }
+
+        for (std::size_t i = 0; i < texels.size(); ++i) {
+            rgba alpha {};
+            alpha[3] = texels[i][3];
+            indices |= static_cast<std::uint64_t>(find_nearest(palette, alpha, 4)) << (3 * i);
+        }
+    }
+
+    output[0] = static_cast<std::byte>(alpha0);
+    output[1] = static_cast<std::byte>(alpha1);
+    for (int i = 0; i < 6; ++i) {
+        output[2 + i] = static_cast<std::byte>((indices >> (8 * i)) & 0xFF);
+    }
+}
+
+std::vector<std::byte> compress_level(const MipLevel &level, BlockFormat format) {
+    const std::size_t block_size { GetBlockSize(format) };
+    std::vector<std::byte> data(GetCompressedSize(format, level.width, level.height));
+
+    std::byte *output { data.data() };
+    for (auto y = 0u; y < level.height; y += 4) {
+        for (auto x = 0u; x < level.width; x += 4) {
+            block texels;
+            for (auto i = 0u; i < texels.size(); ++i) {
+                texels[i] = level.at(x + i % 4, y + i / 4);  // replicates the edges of partial blocks
+            }
+
+            if (format == BlockFormat::BC3) {
+                encode_alpha_block(texels, output);
+                encode_color_block(texels, output + 8);
+            } else {
+                encode_color_block(texels, output);
+            }
+            output += block_size;
+        }
+    }
+    return data;
+}
+
+/*********************************************************
+ *                    Block Decoding Code                *
+ *********************************************************/
+void decode_color_block(const std::byte *input, bool bc1, block &texels) noexcept {
+    std::uint16_t color0;
+    std::uint16_t color1;
+    std::uint32_t indices;
+    std::memcpy(&color0, input, 2);
+    std::memcpy(&color1, input + 2, 2);
+    std::memcpy(&indices, input + 4, 4);
+
+    const rgba c0 { from_565(color0) };
+    const rgba c1 { from_565(color1) };
+    std::array<rgba, 4> palette { c0, c1 };
+    if (color0 > color1 || !bc1) {  // BC3 color blocks always use the 4 color mode
+        palette[2] = { mix(c0[0], c1[0], 2, 1), mix(c0[1], c1[1], 2, 1), mix(c0[2], c1[2], 2, 1), 255 };
+        palette[3] = { mix(c0[0], c1[0], 1, 2), mix(c0[1], c1[1], 1, 2), mix(c0[2], c1[2], 1, 2), 255 };
+    } else {
+        palette[2] = { mix(c0[0], c1[0], 1, 1), mix(c0[1], c1[1], 1, 1), mix(c0[2], c1[2], 1, 1), 255 };
+        palette[3] = { 0, 0, 0, 0 };  // transparent black
+    }
+
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        const std::uint8_t alpha { texels[i][3] };
+        texels[i] = palette[(indices >> (2 * i)) & 0x3u];
+        if (!bc1) {
+            texels[i][3] = alpha;  // decoded from the alpha block before
+        }
+    }
+}
+
+void decode_alpha_block(const std::byte *input, block &texels) noexcept {
+    const auto alpha0 { static_cast<std::uint8_t>(input[0]) };
+    const auto alpha1 { static_cast<std::uint8_t>(input[1]) };
+    std::uint64_t indices { 0 };
+    for (int i = 0; i < 6; ++i) {
+        indices |= static_cast<std::uint64_t>(input[2 + i]) << (8 * i);
+    }
+
+    std::array<std::uint8_t, 8> palette { alpha0, alpha1 };
+    if (alpha0 > alpha1) {
+        for (unsigned i = 1; i < 7; ++i) {
+            palette[i + 1] = mix(alpha0, alpha1, 7 - i, i);
+        }
+    } else {
+        for (unsigned i = 1; i < 5; ++i) {
+            palette[i + 1] = mix(alpha0, alpha1, 5 - i, i);
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    for (std::size_t i = 0; i < texels.size(); ++i) {
+        texels[i][3] = palette[(indices >> (3 * i)) & 0x7u];
+    }
+}
+
+bool is_opaque(const MipLevel &level) noexcept {
+    return std::all_of(level.texels.begin(), level.texels.end(),
+                       [] (const rgba &texel) { return texel[3] == 255; });
+}
+
+/*********************************************************
+ *                        DDS Code                       *
+ *********************************************************/
+constexpr std::uint32_t dds_magic { 0x20534444 };  // "DDS "
+constexpr std::uint32_t dxt1 { 0x31545844 };       // "DXT1"
+constexpr std::uint32_t dxt5 { 0x35545844 };       // "DXT5"
+
+/**
+ * @see https://docs.microsoft.com/en-us/windows/win32/direct3ddds/dds-header
+ */
+struct DDSHeader {
+    std::uint32_t size { 124 };
+    std::uint32_t flags { 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000 };  // caps, height, width, pixel format, mip map count, linear size
+    std::uint32_t height { 0 };
+    std::uint32_t width { 0 };
+    std::uint32_t linearSize { 0 };
+    std::uint32_t depth { 0 };
+    std::uint32_t mipMapCount { 0 };
+    std::uint32_t reserved1[11] {};
+    struct {
+        std::uint32_t size { 32 };
+        std::uint32_t flags { 0x4 };  // four CC
+        std::uint32_t fourCC { 0 };
+        std::uint32_t rgbBitCount { 0 };
+        std::uint32_t masks[4] {};
+    } pixelFormat;
+    std::uint32_t caps { 0x8 | 0x1000 | 0x400000 };  // complex, texture, mip map
+    std::uint32_t caps2 { 0 };
+    std::uint32_t caps3 { 0 };
+    std::uint32_t caps4 { 0 };
+    std::uint32_t reserved2 { 0 };
+};
+static_assert(sizeof(DDSHeader) == 124);
+
+}  // anonymous namespace
+
+std::size_t GetBlockSize(BlockFormat format) noexcept {
+    return format == BlockFormat::BC1 ? 8 : 16;
+}
+
+std::size_t GetCompressedSize(BlockFormat format, std::uint32_t width, std::uint32_t height) noexcept {
+    const std::size_t blocks_x { std::max((width + 3) / 4, 1u) };
+    const std::size_t blocks_y { std::max((height + 3) / 4, 1u) };
+    return blocks_x * blocks_y * GetBlockSize(format);
+}
+
+CompressedImage CompressImage(const std::vector<MipLevel> &levels) {
+    if (levels.empty()) {
+        throw std::invalid_argument { "cannot compress an empty mip chain" };
+    }
+
+    CompressedImage compressed {
+        .format = is_opaque(levels.front()) ? BlockFormat::BC1 : BlockFormat::BC3,
+        .width = levels.front().width,
+        .height = levels.front().height,
+        .levels = {}
+    };
+    for (const MipLevel &level : levels) {
+        compressed.levels.push_back(compress_level(level, compressed.format));
+    }
+    return compressed;
+}
+
+MipLevel DecompressLevel(BlockFormat format, const std::vector<std::byte> &data,
+                         std::uint32_t width, std::uint32_t height) {
+    if (data.size() != GetCompressedSize(format, width, height)) {
+        throw std::invalid_argument { "the size of the compressed data does not match the level size" };
+    }
+
+    MipLevel level { width, height, std::vector<rgba>(std::size_t { width } * height) };
+    const std::size_t block_size { GetBlockSize(format) };
+    const std::byte *input { data.data() };
+    for (auto y = 0u; y < height; y += 4) {
+        for (auto x = 0u; x < width; x += 4) {
+            block texels {};
+            if (format == BlockFormat::BC3) {
+                decode_alpha_block(input, texels);
+                decode_color_block(input + 8, false, texels);
+            } else {
+                decode_color_block(input, true, texels);
+            }
+            input += block_size;
+
+            // drops the texels of partial blocks that lie outside of the level
+            for (auto i = 0u; i < texels.size(); ++i) {
+                if (x + i % 4 < width && y + i / 4 < height) {
+                    level.texels[(y + i / 4) * width + x + i % 4] = texels[i];
+                }
+            }
+        }
+    }
+    return level;
+}
+
+std::filesystem::path GetCompressedPath(const std::filesystem::path &path, MipFilter filter) {
+    return std::filesystem::path { path }.concat(filter == MipFilter::Kaiser ? ".kaiser.bc.dds" : ".box.bc.dds");
+}
+
+std::optional<CompressedImage> LoadDDS(const std::filesystem::path &path) {
+    std::ifstream is { path, std::ios::binary };
+    std::uint32_t magic { 0 };
+    DDSHeader header;
+    if (!is.read(reinterpret_cast<char*>(&magic), sizeof(magic)) ||
+        !is.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        magic != dds_magic || header.size != sizeof(DDSHeader) ||
+        header.width == 0 || header.height == 0 || header.mipMapCount == 0 || header.mipMapCount > 32) {
+        return {};
+    }
+
+    CompressedImage image { .format = BlockFormat::BC1, .width = header.width, .height = header.height, .levels = {} };
+    switch (header.pixelFormat.fourCC) {
+        case dxt1: image.format = BlockFormat::BC1; break;
+        case dxt5: image.format = BlockFormat::BC3; break;
+        default: return {};
+    }
+
+    std::uint32_t width { header.width };
+    std::uint32_t height { header.height };
+    for (auto i = 0u; i < header.mipMapCount; ++i) {
+        std::vector<std::byte> level(GetCompressedSize(image.format, width, height));
+        if (!is.read(reinterpret_cast<char*>(level.data()), level.size())) {
+            return {};
+        }
+        image.levels.push_back(std::move(level));
+        width = std::max(width / 2, 1u);
+        height = std::max(height / 2, 1u);
+    }
+    return image;
+}
+
+void SaveDDS(const std::filesystem::path &path, const CompressedImage &image) {
+    DDSHeader header;
+    header.width = image.width;
+    header.height = image.height;
+    header.linearSize = static_cast<std::uint32_t>(GetCompressedSize(image.format, image.width, image.height));
+    header.mipMapCount = static_cast<std::uint32_t>(image.levels.size());
+    header.pixelFormat.fourCC = image.format == BlockFormat::BC1 ? dxt1 : dxt5;
+
+    const std::filesystem::path temporary_path { std::filesystem::path { path }.concat(".tmp") };
+    {
+        std::ofstream os { temporary_path, std::ios::binary | std::ios::trunc };
+        os.write(reinterpret_cast<const char*>(&dds_magic), sizeof(dds_magic));
+        os.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        for (const auto &level : image.levels) {
+            os.write(reinterpret_cast<const char*>(level.data()), level.size());
+        }
+        if (!os.flush()) {
+            throw std::runtime_error { "could not write " + temporary_path.string() };
+        }
+    }
+    std::filesystem::rename(temporary_path, path);
+}
+
+}  // namespace bgl
@@ -0,0 +1,76 @@
+/**
+ * @file texture_compression.hpp
+ * @brief Block compression (BC1/BC3) of textures and DDS files.
+ */
+#ifndef GFX_TEXTURE_COMPRESSION_HPP_
+#define GFX_TEXTURE_COMPRESSION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include "mipmap.hpp"
+
+
+namespace bgl {
+
+enum class BlockFormat {
+    BC1,  // DXT1, opaque RGB
+    BC3   // DXT5, RGB with interpolated alpha
+};
+
+/**
+ * @brief A block compressed image with its full mip chain.
+ */
+struct CompressedImage {
+    BlockFormat format;
+    std::uint32_t width;
+    std::uint32_t height;
+    std::vector<std::vector<std::byte>> levels;  // level 0 first
+};
+
+/**
+ * @brief Returns the size of one 4x4 block in bytes.
+ */
+std::size_t GetBlockSize(BlockFormat format) noexcept;
+
+/**
+ * @brief Returns the size of a compressed mip level in bytes.
+ */
+std::size_t GetCompressedSize(BlockFormat format, std::uint32_t width, std::uint32_t height) noexcept;
+
+/**
+ * @brief Compresses all levels of a mip chain.
+ * @details Opaque images are stored as BC1, all others as BC3.
+ */
+CompressedImage CompressImage(const std::vector<MipLevel> &levels);
+
+/**
+ * @brief Decodes a compressed mip level.
+ * @details A reference decoder for checking the encoder, textures are decoded by the GPU.
+ */
+MipLevel DecompressLevel(BlockFormat format, const std::vector<std::byte> &data,
+                         std::uint32_t width, std::uint32_t height);
+
+/**
+ * @brief Returns the path of the DDS file that caches the compressed form of an image.
+ * @details Mip chains generated with different filters are cached in different files.
+ */
+std::filesystem::path GetCompressedPath(const std::filesystem::path &path, MipFilter filter);
+
+/**
+ * @brief Loads a DDS file.
+ * @return The image or nothing if the file is not a supported DDS file.
+ */
+std::optional<CompressedImage> LoadDDS(const std::filesystem::path &path);
+
+/**
+ * @brief Stores an image as DDS file.
+ */
+void SaveDDS(const std::filesystem::path &path, const CompressedImage &image);
+
+}  // namespace bgl
+
+#endif  // GFX_TEXTURE_COMPRESSION_HPP_
@@ -0,0 +1,49 @@
+#include "thread_pool.hpp"
+
+
+namespace bgl {
+
+ThreadPool::ThreadPool(std::size_t num_threads) {
+    for (std::size_t i = 0; i < num_threads; ++i) {
+        _threads.emplace_back(&ThreadPool::run, this);
+    }
+}
+
+ThreadPool::~ThreadPool() noexcept {
+    {
+        std::lock_guard<std::mutex> lock { _mutex };
+        _stopped = true;
+    }
+    _condition.notify_all();
+
+    for (auto &thread : _threads) {
+        thread.join();
+    }
+}
+
+ThreadPool& ThreadPool::instance() {
+    static ThreadPool pool;
+    return pool;
+}
+
+std::size_t ThreadPool::size() const noexcept {
+    return _threads.size();
+}
+
+void ThreadPool::run() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock { _mutex };
+            _condition.wait(lock, [this] () { return _stopped || !_tasks.empty(); });
+            if (_stopped && _tasks.empty()) {
+                return;
+            }
+            task = std::move(_tasks.front());
+            _tasks.pop();
+        }
+        task();
+    }
+}
+
+}  // namespace bgl
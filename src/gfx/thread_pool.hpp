@@ -0,0 +1,111 @@
+/**
+ * @file thread_pool.hpp
+ * @brief A fixed size worker pool for CPU side import work.
+ */
+#ifndef GFX_THREAD_POOL_HPP_
+#define GFX_THREAD_POOL_HPP_
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+
+namespace bgl {
+
+/**
+ * @brief A non-copyable, non-moveable pool of worker threads.
+ * @note Tasks must not block on other tasks of the same pool.
+ */
+class ThreadPool final {
+ public:
+	explicit ThreadPool(std::size_t num_threads = std::max(1u, std::thread::hardware_concurrency()));
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool() noexcept;
+
+	/**
+	 * @brief Returns the process wide pool.
+	 */
+	static ThreadPool& instance();
+
+	std::size_t size() const noexcept;
+
+	template<typename F>
+	std::future<std::invoke_result_t<F>> submit(F &&function) {
+		using result_type = std::invoke_result_t<F>;
+		const auto task { std::make_shared<std::packaged_task<result_type()>>(std::forward<F>(function)) };
+		std::future<result_type> future { task->get_future() };
+		{
+			std::lock_guard<std::mutex> lock { _mutex };
+			_tasks.emplace([task] () { (*task)(); });
+		}
+		_condition.notify_one();
+		return future;
+	}
+
+ private:
+	void run();
+
+	std::vector<std::thread> _threads;
+	std::queue<std::function<void()>> _tasks;
+	std::mutex _mutex;
+	std::condition_variable _condition;
+	bool _stopped { false };
+};
+
+/**
+ * @brief Calls @p function for every index in [0, @p count) on the pool.
+ * @details The calling thread takes part in the work. The first exception
+ *          thrown by @p function is rethrown once all workers are done.
+ */
+template<typename F>
+void ParallelFor(std::size_t count, F &&function, ThreadPool &pool = ThreadPool::instance()) {
+	std::atomic<std::size_t> next { 0 };
+	std::exception_ptr error;
+	std::mutex error_mutex;
+
+	auto work = [&] () {
+		for (std::size_t i = next++; i < count; i = next++) {
+			try {
+				function(i);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock { error_mutex };
+				if (!error) {
+					error = std::current_exception();
+				}
+				next = count;  // skips the remaining work
+			}
+		}
+	};
+
+	std::vector<std::future<void>> helpers;
+	const std::size_t num_helpers { std::min(pool.size(), count) - (count > 0 ? 1 : 0) };
+	for (std::size_t i = 0; i < num_helpers; ++i) {
+		helpers.push_back(pool.submit(work));
+	}
+
+	work();
+	for (auto &helper : helpers) {
+		helper.wait();
+	}
+
+	if (error) {
+		std::rethrow_exception(error);
+	}
+}
+
+}  // namespace bgl
+
+#endif  // GFX_THREAD_POOL_HPP_
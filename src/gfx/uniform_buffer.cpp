@@ -0,0 +1,159 @@
+#include <algorithm>
+#include <stdexcept>
+#include <utility>  // std::exchange()
+
+#include "uniform_buffer.hpp"
+
+#include <QOpenGLShaderProgram>  // NOLINT
+
+
+namespace bgl {
+
+namespace {
+
+bool is_equal(const DirectionalLight &lhs, const DirectionalLight &rhs) noexcept {
+    return lhs.direction == rhs.direction && lhs.diffuse == rhs.diffuse && lhs.ambient == rhs.ambient;
+}
+
+void bind_block(GLuint program, const char *name, UniformBlock block) {
+    const GLuint index { glGetUniformBlockIndex(program, name) };
+    if (index != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program, index, static_cast<GLuint>(block));
+    }
+}
+
+}  // anonymous namespace
+
+MaterialBlock GetMaterialBlock(const Material &material) {
+    MaterialBlock block {};
+    block.ambient = material.ambient;
+    block.diffuse = material.diffuse;
+    block.specular = material.specular;
+    block.shininess = material.shininess;
+
+    /**
+     * @note There is currently only support for diffuse texture maps.
+     */
+    block.isTextured = material.textures.diffuse != nullptr;
+    return block;
+}
+
+/*********************************************************
+ *                     Uniform Buffer                    *
+ *********************************************************/
+UniformBuffer::UniformBuffer(UniformBuffer &&rhs) noexcept
+    : _handle { std::exchange(rhs._handle, 0) },
+      _size { std::exchange(rhs._size, 0) } {
+}
+
+UniformBuffer& UniformBuffer::operator=(UniformBuffer &&rhs) noexcept {
+    if (this != &rhs) {
+        if (_handle != 0) {
+            glDeleteBuffers(1, &_handle);
+        }
+        _handle = std::exchange(rhs._handle, 0);
+        _size = std::exchange(rhs._size, 0);
+    }
+    return *this;
+}
+
+UniformBuffer::~UniformBuffer() noexcept {
+    if (_handle != 0) {
+        glDeleteBuffers(1, &_handle);
+    }
+}
+
+void UniformBuffer::allocate(const void *data, std::size_t size, GLenum usage) {
+    if (_handle == 0) {
+        glGenBuffers(1, &_handle);
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, _handle);
+    glBufferData(GL_UNIFORM_BUFFER, size, data, usage);
+    _size = size;
+}
+
+void UniformBuffer::write(std::size_t offset, const void *data, std::size_t size) {
+    if (offset + size > _size) {
+        throw std::out_of_range { "uniform buffer write out of range" };
+    }
+    glBindBuffer(GL_UNIFORM_BUFFER, _handle);
+    glBufferSubData(GL_UNIFORM_BUFFER, offset, size, data);
+}
+
+void UniformBuffer::bind(UniformBlock block) const {
+    glBindBufferBase(GL_UNIFORM_BUFFER, static_cast<GLuint>(block), _handle);
+}
+
+void UniformBuffer::bind(UniformBlock block, std::size_t offset, std::size_t size) const {
+    glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(block), _handle, offset, size);
+}
+
+std::size_t UniformBuffer::size() const noexcept {
+    return _size;
+}
+
+bool UniformBuffer::isCreated() const noexcept {
+    return _handle != 0;
+}
+
+std::size_t GetUniformBufferAlignment() {
+    static const std::size_t alignment {
+        [] {
+            GLint value { 0 };
+            glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &value);
+            return static_cast<std::size_t>(std::max(value, 1));
+        }()
+    };
+    return alignment;
+}
+
+std::size_t GetUniformBufferStride(std::size_t size) {
+    const std::size_t alignment { GetUniformBufferAlignment() };
+    return (size + alignment - 1) / alignment * alignment;
+}
+
+void BindUniformBlocks(QOpenGLShaderProgram &program) {
+    bind_block(program.programId(), "FrameBlock", UniformBlock::Frame);
+    bind_block(program.programId(), "MaterialBlock", UniformBlock::Material);
+}
+
+/*********************************************************
+ *                     Frame Uniforms                    *
+ *********************************************************/
+void FrameUniforms::setLight(const DirectionalLight &light) {
+    StreamBuffer &stream { StreamBuffer::instance() };
+    const bool isCurrent { _frame == stream.getFrame() && _light.has_value() && is_equal(_light.value(), light) };
+    if (!isCurrent) {
+        FrameBlock block {};
+        block.light.direction = light.direction;
+        block.light.ambient = light.ambient;
+        block.light.diffuse = light.diffuse;
+
+        _allocation = stream.write(&block, sizeof(block), GetUniformBufferAlignment());
+        if (!_allocation.has_value()) {
+            _buffer.allocate(&block, sizeof(block), GL_STREAM_DRAW);
+        }
+        _light = light;
+        _frame = stream.getFrame();
+    }
+
+    if (_allocation.has_value()) {
+        glBindBufferRange(GL_UNIFORM_BUFFER, static_cast<GLuint>(UniformBlock::Frame), _allocation->buffer,
+                          _allocation->offset, sizeof(FrameBlock));
+    } else {
+        _buffer.bind(UniformBlock::Frame);
+    }
+}
+
+std::shared_ptr<FrameUniforms> GetFrameUniforms() {
+    static std::weak_ptr<FrameUniforms> instance;
+
+    std::shared_ptr<FrameUniforms> uniforms { instance.lock() };
+    if (!uniforms) {
+        uniforms = std::make_shared<FrameUniforms>();
+        instance = uniforms;
+    }
+    return uniforms;
+}
+
+}  // namespace bgl
@@ -0,0 +1,141 @@
+/**
+ * @file uniform_buffer.hpp
+ * @brief std140 uniform blocks and the buffers backing them.
+ */
+#ifndef GFX_UNIFORM_BUFFER_HPP_
+#define GFX_UNIFORM_BUFFER_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+#include "gl.hpp"
+#include "math.hpp"
+#include "material.hpp"
+#include "scene.hpp"
+#include "stream_buffer.hpp"
+
+class QOpenGLShaderProgram;
+
+
+namespace bgl {
+
+/**
+ * @brief Binding points of the uniform blocks shared by all programs.
+ */
+enum class UniformBlock : GLuint {
+    Frame = 0,    // "FrameBlock", updated once per frame
+    Material = 1  // "MaterialBlock", a range of the material buffer of a model
+};
+
+/**
+ * @brief Mirror of the std140 layout of "FrameBlock".
+ */
+struct FrameBlock {
+	struct {
+		vec3 direction;
+		float padding0;
+		vec3 ambient;
+		float padding1;
+		vec3 diffuse;
+		float padding2;
+		vec3 specular;
+		float padding3;
+	} light;
+};
+
+/**
+ * @brief Mirror of the std140 layout of "MaterialBlock".
+ * @details The scalars fill the gaps that std140 leaves behind each vec3.
+ */
+struct MaterialBlock {
+	vec3 ambient;
+	float shininess;
+	vec3 diffuse;
+	GLuint isTextured;  // a bool is 4 bytes in std140
+	vec3 specular;
+	float padding;
+};
+
+static_assert(sizeof(FrameBlock) == 64, "FrameBlock does not match its std140 layout");
+static_assert(sizeof(MaterialBlock) == 48, "MaterialBlock does not match its std140 layout");
+
+/**
+ * @brief Returns the uniform block of a material.
+ */
+MaterialBlock GetMaterialBlock(const Material &material);
+
+/**
+ * @brief A non-copyable, but moveable OpenGL uniform buffer.
+ * @details The buffer object is created with its first allocation.
+ */
+class UniformBuffer final {
+ public:
+	UniformBuffer() = default;
+	UniformBuffer(UniformBuffer &&rhs) noexcept;
+	UniformBuffer& operator=(UniformBuffer &&rhs) noexcept;
+
+	UniformBuffer(const UniformBuffer&) = delete;
+	UniformBuffer& operator=(const UniformBuffer&) = delete;
+
+	~UniformBuffer() noexcept;
+
+	void allocate(const void *data, std::size_t size, GLenum usage = GL_STATIC_DRAW);
+	void write(std::size_t offset, const void *data, std::size_t size);
+
+	void bind(UniformBlock block) const;
+	void bind(UniformBlock block, std::size_t offset, std::size_t size) const;
+
+	std::size_t size() const noexcept;
+	bool isCreated() const noexcept;
+
+ private:
+	GLuint _handle { 0 };
+	std::size_t _size { 0 };
+};
+
+/**
+ * @brief Returns the alignment of the offsets passed to glBindBufferRange().
+ */
+std::size_t GetUniformBufferAlignment();
+
+/**
+ * @brief Rounds @p size up to a valid offset of a uniform buffer range.
+ */
+std::size_t GetUniformBufferStride(std::size_t size);
+
+/**
+ * @brief Assigns the uniform blocks of a program to their binding points.
+ * @note Blocks the program does not declare are skipped.
+ */
+void BindUniformBlocks(QOpenGLShaderProgram &program);
+
+/**
+ * @brief The per-frame uniform block shared by all models.
+ * @details The block is streamed through the StreamBuffer once per frame.
+ */
+class FrameUniforms final {
+ public:
+	FrameUniforms() = default;
+
+	/**
+	 * @brief Streams the light unless the current frame already did and binds the block.
+	 */
+	void setLight(const DirectionalLight &light);
+
+ private:
+	std::optional<StreamAllocation> _allocation;  // of the current block, if it fit into the stream
+	UniformBuffer _buffer;                        // otherwise
+	std::optional<DirectionalLight> _light;
+	std::optional<std::size_t> _frame;            // of the stream the light was written in
+};
+
+/**
+ * @brief Returns the per-frame uniform block that is shared by all models.
+ * @note The OpenGL context has to be current.
+ */
+std::shared_ptr<FrameUniforms> GetFrameUniforms();
+
+}  // namespace bgl
+
+#endif  // GFX_UNIFORM_BUFFER_HPP_
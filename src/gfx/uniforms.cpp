@@ -0,0 +1,56 @@
+#include "gl.hpp"
+
+#include <algorithm>  // std::max()
+#include <stdexcept>
+#include <vector>
+
+#include "uniforms.hpp"
+
+#include <QOpenGLShaderProgram>
+
+
+namespace bgl {
+
+UniformTable::UniformTable(QOpenGLShaderProgram &program) {
+    if (!program.isLinked() && !program.link()) {
+        throw std::runtime_error { "could not link program: " + program.log().toStdString() };
+    }
+
+    const GLuint id { program.programId() };
+    GLint num_uniforms { 0 };
+    GLint max_length { 0 };
+    glGetProgramiv(id, GL_ACTIVE_UNIFORMS, &num_uniforms);
+    glGetProgramiv(id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &max_length);
+
+    std::vector<GLchar> buffer(std::max(max_length, 1));
+    for (auto i = 0; i < num_uniforms; ++i) {
+        GLsizei length { 0 };
+        GLint size { 0 };
+        GLenum type { GL_NONE };
+        glGetActiveUniform(id, static_cast<GLuint>(i), static_cast<GLsizei>(buffer.size()), &length, &size, &type,
+                           buffer.data());
+
+        const std::string name { buffer.data(), static_cast<std::size_t>(length) };
+        const GLint location { glGetUniformLocation(id, name.c_str()) };
+        if (location < 0) {
+            continue;  // member of a uniform block
+        }
+
+        _locations[name] = location;
+        const auto bracket { name.find("[0]") };
+        if (bracket != std::string::npos && bracket + 3 == name.size()) {
+            _locations[name.substr(0, bracket)] = location;
+        }
+    }
+}
+
+GLint UniformTable::getLocation(const std::string &name) const noexcept {
+    const auto location { _locations.find(name) };
+    return location != _locations.end() ? location->second : -1;
+}
+
+std::size_t UniformTable::size() const noexcept {
+    return _locations.size();
+}
+
+}  // namespace bgl
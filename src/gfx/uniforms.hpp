@@ -0,0 +1,42 @@
+/**
+ * @file uniforms.hpp
+ * @brief Uniform locations resolved once per program.
+ */
+#ifndef GFX_UNIFORMS_HPP_
+#define GFX_UNIFORMS_HPP_
+
+#include <string>
+#include <unordered_map>
+
+#include "gl.hpp"
+
+class QOpenGLShaderProgram;
+
+
+namespace bgl {
+
+/**
+ * @brief Locations of all active uniforms of a linked program.
+ * @details The uniforms are reflected once, so the hot path does not need
+ *          name lookups in the driver. Elements of uniform arrays are
+ *          available both as "name[0]" and "name".
+ */
+class UniformTable final {
+ public:
+	UniformTable() = default;
+	explicit UniformTable(QOpenGLShaderProgram &program);
+
+	/**
+	 * @return The location or -1 if the program has no such active uniform.
+	 */
+	GLint getLocation(const std::string &name) const noexcept;
+
+	std::size_t size() const noexcept;
+
+ private:
+	std::unordered_map<std::string, GLint> _locations;
+};
+
+}  // namespace bgl
+
+#endif  // GFX_UNIFORMS_HPP_
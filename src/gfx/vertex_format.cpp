@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "vertex_format.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+/*********************************************************
+ *                   Octahedral Normals                  *
+ *********************************************************/
+inline float sign_not_zero(float value) noexcept {
+    return value < 0.0f ? -1.0f : 1.0f;
+}
+
+vec2 encode_octahedral(const vec3 &normal) noexcept {
+    const float length { std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z) };
+    if (length == 0.0f) {
+        return vec2 { 0.0f };
+    }
+
+    const vec3 n { normal / length };
+    if (n.z >= 0.0f) {
+        return vec2 { n.x, n.y };
+    }
+    return vec2 { (1.0f - std::abs(n.y)) * sign_not_zero(n.x), (1.0f - std::abs(n.x)) * sign_not_zero(n.y) };
+}
+
+vec3 decode_octahedral(const vec2 &encoded) noexcept {
+    vec3 n { encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y) };
+    if (n.z < 0.0f) {
+        n = vec3 { (1.0f - std::abs(encoded.y)) * sign_not_zero(encoded.x),
+                   (1.0f - std::abs(encoded.x)) * sign_not_zero(encoded.y), n.z };
+    }
+    return glm::normalize(n);
+}
+
+/*********************************************************
+ *                  Normalized Integers                  *
+ *********************************************************/
+inline std::uint16_t to_unorm16(float value) noexcept {
+    return static_cast<std::uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * 65535.0f));
+}
+
+inline float from_unorm16(std::uint16_t value) noexcept {
+    return value / 65535.0f;
+}
+
+inline std::int16_t to_snorm16(float value) noexcept {
+    return static_cast<std::int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * 32767.0f));
+}
+
+inline float from_snorm16(std::int16_t value) noexcept {
+    return std::max(value / 32767.0f, -1.0f);  // as OpenGL does
+}
+
+float get_angle(const vec3 &a, const vec3 &b) noexcept {
+    const float length { glm::length(a) * glm::length(b) };
+    if (length == 0.0f) {
+        return 0.0f;
+    }
+    return glm::degrees(std::acos(std::clamp(glm::dot(a, b) / length, -1.0f, 1.0f)));
+}
+
+float get_max_difference(const vec3 &a, const vec3 &b) noexcept {
+    const vec3 difference { glm::abs(a - b) };
+    return std::max({ difference.x, difference.y, difference.z });
+}
+
+}  // anonymous namespace
+
+std::size_t GetVertexSize(VertexFormat format) noexcept {
+    return format == VertexFormat::Compact ? sizeof(CompactVertex) : sizeof(Vertex);
+}
+
+CompactVertices CompressVertices(const Vertex *vertices, std::size_t count) {
+    vec3 min { std::numeric_limits<float>::max() };
+    vec3 max { std::numeric_limits<float>::lowest() };
+    vec2 min_texcoords { std::numeric_limits<float>::max() };
+    vec2 max_texcoords { std::numeric_limits<float>::lowest() };
+    for (auto i = 0u; i < count; ++i) {
+        min = glm::min(min, vertices[i].position);
+        max = glm::max(max, vertices[i].position);
+        min_texcoords = glm::min(min_texcoords, vertices[i].texcoords);
+        max_texcoords = glm::max(max_texcoords, vertices[i].texcoords);
+    }
+
+    CompactVertices compact;
+    if (count == 0) {
+        return compact;
+    }
+
+    const vec3 size { max - min };
+    compact.quantization.offset = min;
+    compact.quantization.scale = size;  // unorm16 is in [0, 1] in the shader
+
+    const vec2 texcoords_size { max_texcoords - min_texcoords };
+    compact.quantization.texcoordOffset = min_texcoords;
+    compact.quantization.texcoordScale = texcoords_size;
+
+    compact.vertices.resize(count);
+    for (auto i = 0u; i < count; ++i) {
+        const Vertex &vertex { vertices[i] };
+        CompactVertex &quantized { compact.vertices[i] };
+
+        for (auto axis = 0; axis < 3; ++axis) {
+            const float relative { size[axis] > 0.0f ? (vertex.position[axis] - min[axis]) / size[axis] : 0.0f };
+            quantized.position[axis] = to_unorm16(relative);
+        }
+        quantized.position[3] = 0;
+
+        const vec2 normal { encode_octahedral(vertex.normal) };
+        quantized.normal[0] = to_snorm16(normal.x);
+        quantized.normal[1] = to_snorm16(normal.y);
+
+        for (auto axis = 0; axis < 2; ++axis) {
+            const float relative { texcoords_size[axis] > 0.0f
+                ? (vertex.texcoords[axis] - min_texcoords[axis]) / texcoords_size[axis] : 0.0f };
+            quantized.texcoords[axis] = to_unorm16(relative);
+        }
+
+        // measures what the vertex shader will see
+        const vec3 position { DecodePosition(quantized, compact.quantization) };
+        const vec3 decoded_normal { decode_octahedral(vec2 { from_snorm16(quantized.normal[0]),
+                                                             from_snorm16(quantized.normal[1]) }) };
+        const vec2 texcoords { min_texcoords + texcoords_size * vec2 { from_unorm16(quantized.texcoords[0]),
+                                                                       from_unorm16(quantized.texcoords[1]) } };
+
+        compact.error.position = std::max(compact.error.position, get_max_difference(position, vertex.position));
+        compact.error.normal = std::max(compact.error.normal, get_angle(decoded_normal, vertex.normal));
+        compact.error.texcoords = std::max({ compact.error.texcoords,
+                                             std::abs(texcoords.x - vertex.texcoords.x),
+                                             std::abs(texcoords.y - vertex.texcoords.y) });
+    }
+    return compact;
+}
+
+vec3 DecodePosition(const CompactVertex &vertex, const VertexQuantization &quantization) noexcept {
+    return quantization.offset + quantization.scale * vec3 { from_unorm16(vertex.position[0]),
+                                                             from_unorm16(vertex.position[1]),
+                                                             from_unorm16(vertex.position[2]) };
+}
+
+}  // namespace bgl
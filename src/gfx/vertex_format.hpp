@@ -0,0 +1,83 @@
+/**
+ * @file vertex_format.hpp
+ * @brief Vertex layouts of the VBOs and conversion between them.
+ */
+#ifndef GFX_VERTEX_FORMAT_HPP_
+#define GFX_VERTEX_FORMAT_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "gl.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief OpenGL VBO vertex format.
+ */
+struct Vertex {
+    vec3 position;
+    vec3 normal;
+    vec2 texcoords;
+};
+
+/**
+ * @brief Quantized vertex, half the size of a Vertex.
+ */
+struct CompactVertex {
+    std::uint16_t position[4];   // normalized within the mesh bounds, the 4th is padding
+    std::int16_t normal[2];      // octahedral encoded, normalized
+    std::uint16_t texcoords[2];  // normalized within the mesh's UV bounds
+};
+
+enum class VertexFormat {
+    Float,   // Vertex
+    Compact  // CompactVertex
+};
+
+/**
+ * @brief Maps stored positions to model space: offset + scale * position,
+ *        and stored texture coordinates likewise.
+ */
+struct VertexQuantization {
+    vec3 offset { 0.0f };
+    vec3 scale { 1.0f };
+    vec2 texcoordOffset { 0.0f };
+    vec2 texcoordScale { 1.0f };
+};
+
+/**
+ * @brief Largest difference between the original and the quantized vertices.
+ */
+struct QuantizationError {
+    float position { 0.0f };   // in model units
+    float normal { 0.0f };     // in degrees
+    float texcoords { 0.0f };
+};
+
+/**
+ * @brief Quantized vertices of a mesh.
+ */
+struct CompactVertices {
+    std::vector<CompactVertex> vertices;
+    VertexQuantization quantization;  // relative to the bounds of the mesh
+    QuantizationError error;
+};
+
+std::size_t GetVertexSize(VertexFormat format) noexcept;
+
+/**
+ * @brief Quantizes the vertices of a mesh and measures the error.
+ */
+CompactVertices CompressVertices(const Vertex *vertices, std::size_t count);
+
+/**
+ * @brief Returns the model space position of a quantized vertex as the vertex shaders decode it.
+ */
+vec3 DecodePosition(const CompactVertex &vertex, const VertexQuantization &quantization) noexcept;
+
+}  // namespace bgl
+
+#endif  // GFX_VERTEX_FORMAT_HPP_
@@ -0,0 +1,76 @@
+/**
+ * @file frame_timer.cpp
+ * @brief Wall clock frame times over the last frames
+ */
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#include "frame_timer.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+using milliseconds = std::chrono::duration<double, std::milli>;
+
+/**
+ * @brief Returns the nearest-rank percentile of sorted values.
+ */
+double get_percentile(const std::vector<double> &sorted, double percentile) {
+    const auto rank { static_cast<std::size_t>(std::ceil(percentile * sorted.size())) };
+    return sorted[std::max<std::size_t>(rank, 1) - 1];
+}
+
+}  // anonymous namespace
+
+double FrameTimer::begin() noexcept {
+    const Clock::time_point now { Clock::now() };
+    const double delta { _started ? milliseconds { now - _begin }.count() : 0.0 };
+    _begin = now;
+    _started = true;
+    _running = true;
+    return delta;
+}
+
+void FrameTimer::end() noexcept {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+    record(milliseconds { Clock::now() - _begin }.count());
+}
+
+void FrameTimer::record(double duration) noexcept {
+    _times[_next] = duration;
+    _next = (_next + 1) % window;
+    ++_count;
+}
+
+std::size_t FrameTimer::getFrameCount() const noexcept {
+    return _count;
+}
+
+FrameTimer::Statistics FrameTimer::getStatistics() const {
+    const std::size_t frames { std::min(_count, window) };
+    if (frames == 0) {
+        return Statistics {};
+    }
+
+    std::vector<double> sorted(_times.begin(), _times.begin() + frames);
+    std::sort(sorted.begin(), sorted.end());
+
+    Statistics statistics;
+    statistics.frames = frames;
+    statistics.min = sorted.front();
+    statistics.avg = std::accumulate(sorted.begin(), sorted.end(), 0.0) / frames;
+    statistics.p50 = get_percentile(sorted, 0.50);
+    statistics.p95 = get_percentile(sorted, 0.95);
+    statistics.p99 = get_percentile(sorted, 0.99);
+    statistics.max = sorted.back();
+    return statistics;
+}
+
+}  // namespace bgl
@@ -0,0 +1,73 @@
+/**
+ * @file frame_timer.hpp
+ * @brief Wall clock frame times over the last frames
+ */
+#ifndef GUI_FRAME_TIMER_HPP_
+#define GUI_FRAME_TIMER_HPP_
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+
+namespace bgl {
+
+/**
+ * @brief Measures how long frames take with a steady clock, or keeps durations measured elsewhere.
+ * @details Keeps the durations of the last frames in a ring buffer, so the
+ *          statistics follow the current load instead of the whole runtime.
+ */
+class FrameTimer final {
+ public:
+	using Clock = std::chrono::steady_clock;
+
+	static constexpr std::size_t window { 256 };  // frames the statistics are computed over
+
+	/**
+	 * @brief Frame durations in milliseconds over the last window frames.
+	 */
+	struct Statistics {
+		std::size_t frames;  // in the window, the other members are 0 without any
+		double min;
+		double avg;
+		double p50;
+		double p95;
+		double p99;
+		double max;
+	};
+
+	/**
+	 * @brief Starts timing a frame.
+	 * @return The milliseconds since the previous frame started, 0 for the first frame.
+	 */
+	double begin() noexcept;
+
+	/**
+	 * @brief Stops timing the frame started last and records its duration.
+	 */
+	void end() noexcept;
+
+	/**
+	 * @brief Records the duration of a frame measured elsewhere, e.g. by a GpuTimer.
+	 */
+	void record(double duration) noexcept;  // [ms]
+
+	/**
+	 * @brief Returns the number of frames recorded since the timer was created.
+	 */
+	std::size_t getFrameCount() const noexcept;
+
+	Statistics getStatistics() const;
+
+ private:
+	Clock::time_point _begin;
+	bool _running { false };
+	bool _started { false };  // whether _begin holds the start of a frame
+	std::array<double, window> _times {};  // ring buffer of milliseconds
+	std::size_t _next { 0 };
+	std::size_t _count { 0 };
+};
+
+}  // namespace bgl
+
+#endif  // GUI_FRAME_TIMER_HPP_
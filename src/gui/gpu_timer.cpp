@@ -0,0 +1,52 @@
+/**
+ * @file gpu_timer.cpp
+ * @brief GPU frame times from OpenGL timer queries
+ */
+#include "gpu_timer.hpp"
+
+
+namespace bgl {
+
+void GpuTimer::begin() {
+    if (_queries.front() == 0) {
+        glGenQueries(static_cast<GLsizei>(_queries.size()), _queries.data());
+    }
+    if (_running || _pending == latency) {
+        return;  // the oldest query is still in use
+    }
+
+    glBeginQuery(GL_TIME_ELAPSED, _queries[_next]);
+    _running = true;
+}
+
+void GpuTimer::end() {
+    if (!_running) {
+        return;
+    }
+    _running = false;
+
+    glEndQuery(GL_TIME_ELAPSED);
+    _next = (_next + 1) % latency;
+    ++_pending;
+}
+
+std::size_t GpuTimer::collect(FrameTimer &timer) {
+    std::size_t num_collected { 0 };
+    while (_pending > 0) {
+        const GLuint query { _queries[(_next + latency - _pending) % latency] };
+        GLint available { GL_FALSE };
+        glGetQueryObjectiv(query, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available == GL_FALSE) {
+            break;  // the later ones are not finished either
+        }
+
+        GLuint64 nanoseconds { 0 };
+        glGetQueryObjectui64v(query, GL_QUERY_RESULT, &nanoseconds);
+        timer.record(static_cast<double>(nanoseconds) / 1e6);
+        --_pending;
+        ++num_collected;
+    }
+    return num_collected;
+}
+
+}  // namespace bgl
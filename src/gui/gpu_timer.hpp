@@ -0,0 +1,54 @@
+/**
+ * @file gpu_timer.hpp
+ * @brief GPU frame times from OpenGL timer queries
+ */
+#ifndef GUI_GPU_TIMER_HPP_
+#define GUI_GPU_TIMER_HPP_
+
+#include <array>
+#include <cstddef>
+
+#include "../gfx/gl.hpp"
+#include "frame_timer.hpp"
+
+
+namespace bgl {
+
+/**
+ * @brief Measures how long the GPU takes to execute the commands of a frame with GL_TIME_ELAPSED queries.
+ * @details The results become available some frames later, so the queries are
+ *          kept in a ring and read back without waiting for the GPU. Frames that
+ *          begin while all queries are still pending are not timed.
+ * @note The queries are created with the context that is current on the first begin().
+ */
+class GpuTimer final {
+ public:
+	static constexpr std::size_t latency { 4 };  // frames that can be timed before the first result is read back
+
+	GpuTimer() noexcept = default;
+
+	GpuTimer(const GpuTimer&) = delete;
+	GpuTimer& operator=(const GpuTimer&) = delete;
+
+	/**
+	 * @brief Starts timing the commands issued until end().
+	 */
+	void begin();
+	void end();
+
+	/**
+	 * @brief Records the durations of the frames the GPU finished in @p timer.
+	 * @return The number of recorded frames.
+	 */
+	std::size_t collect(FrameTimer &timer);
+
+ private:
+	std::array<GLuint, latency> _queries {};
+	std::size_t _next { 0 };     // query of the next frame
+	std::size_t _pending { 0 };  // ended, but not read back, the oldest one comes first
+	bool _running { false };
+};
+
+}  // namespace bgl
+
+#endif  // GUI_GPU_TIMER_HPP_
@@ -4,73 +4,153 @@
 #include <QMenuBar>
 #include <QMessageBox>
 #include <QProgressBar>
+#include <QStatusBar>
+#include <QTimer>
 
+#include <array>
+#include <atomic>
 #include <optional>
 #include <filesystem>
 #include <memory>
 
 #include "menu.hpp"
-#include "../gfx/model.hpp"  // TODO
+#include "../gfx/importer.hpp"  // TODO
 
 
 namespace {
 
 inline std::optional<std::filesystem::path> chooseFile() {
     const QString fileName { QFileDialog::getOpenFileName(nullptr, "Load 3D Model", "", "All Files (*)") };
-    return fileName.isEmpty() ? std::filesystem::path{} : std::filesystem::path { fileName.toStdString() };
-}
-
-/**
- * @brief Selects and loads a 3D model.
- */
-void load3DModel() {
-    std::optional<std::filesystem::path> path { chooseFile() };
-    if (!path.has_value()) {
-        QMessageBox::information(nullptr, "Warning", "No file chosen.");
-        return;
+    if (fileName.isEmpty()) {
+        return {};
     }
-
-    QProgressBar progressBar;
-    progressBar.show();
-    progressBar.setValue(0);
-
-    std::shared_ptr<bgl::Model> model;
-    try {
-        model = bgl::LoadModel(path.value());
-        // TODO: update progress bar
-    } catch (std::exception &exception) {
-        QMessageBox::critical(nullptr, "Error", exception.what());
-        progressBar.reset();
-        progressBar.hide();
-        return;
-    }
-
-    // TODO: update model statistics panel
-    progressBar.setValue(100);
-    progressBar.hide();
-    // TODO: update model in viewport
+    return std::filesystem::path { fileName.toStdString() };
 }
 
 inline void showAboutBox() {
     QMessageBox::about(nullptr, "About,", "A simple Qt OpenGL demo.");
 }
 
+/**
+ * @brief The latest progress reported by the loading threads.
+ */
+struct LoadState {
+    std::atomic<bgl::LoadStage> stage { bgl::LoadStage::Parsing };
+    std::atomic<float> progress { 0.0f };
+};
+
+struct StageInfo {
+    const char *name;
+    int begin;  // [%]
+    int end;    // [%]
+};
+
+StageInfo get_stage_info(bgl::LoadStage stage) noexcept {
+    switch (stage) {
+        case bgl::LoadStage::Parsing:         return { "Parsing", 0, 30 };
+        case bgl::LoadStage::PostProcessing:  return { "Post-processing", 30, 50 };
+        case bgl::LoadStage::BuildingBuffers: return { "Building buffers", 50, 70 };
+        case bgl::LoadStage::LoadingTextures: return { "Loading textures", 70, 90 };
+        case bgl::LoadStage::Uploading:       return { "Uploading", 90, 100 };
+        default:                              return { "Loading", 0, 100 };
+    }
+}
+
 }  // anonymous namespace
 
 namespace bgl {
 
-MenuBar::MenuBar(QMainWindow &window)
+MenuBar::MenuBar(Window &window)
     : _window { window } {
     QMenu * const fileMenu { this->addMenu("&File") };
-    fileMenu->addAction("Load", this, &load3DModel);
+    fileMenu->addAction("Load", [this] () { loadModel(); });
     fileMenu->addAction("Exit", [this] () { _window.close(); });
 
     QMenu * const helpMenu { this->addMenu("&Help") };
     helpMenu->addAction("About", &showAboutBox);
 }
 
+/**
+ * @brief Selects and loads a 3D model.
+ */
+void MenuBar::loadModel() noexcept {
+    const std::optional<std::filesystem::path> path { chooseFile() };
+    if (!path.has_value()) {
+        QMessageBox::information(nullptr, "Warning", "No file chosen.");
+        return;
+    }
+
+    if (_loading) {
+        QMessageBox::information(nullptr, "Warning", "Another model is still being loaded.");
+        return;
+    }
+
+    try {
+        onLoadModel(path.value());
+    } catch (const std::exception &exception) {
+        QMessageBox::critical(nullptr, "Error", exception.what());
+    }
+}
+
 void MenuBar::onLoadModel(const std::filesystem::path &path) {
-    QMessageBox::warning(nullptr, "Warning,", "Not implemented yet.");
+    const ImportOptions options { GetImportOptions() };
+
+    const auto state { std::make_shared<LoadState>() };
+    const auto pending { std::make_shared<PendingModel>(
+        LoadModelAsync(path, [state] (LoadStage stage, float progress) {
+            state->stage = stage;
+            state->progress = progress;
+        }, options)) };
+
+    _loading = true;
+    showProgress(0, "Loading");
+
+    // the models already loaded keep being rendered until the new one is added
+    QTimer * const timer { new QTimer(this) };
+    connect(timer, &QTimer::timeout, this, [this, timer, state, pending] () {
+        const StageInfo stage { get_stage_info(state->stage) };
+        showProgress(stage.begin + static_cast<int>((stage.end - stage.begin) * state->progress), stage.name);
+        if (!pending->isReady()) {
+            return;
+        }
+
+        timer->stop();
+        timer->deleteLater();
+
+        Viewport * const viewport { _window.getViewport() };
+        try {
+            viewport->makeCurrent();
+            _window.addModel(pending->get());
+            viewport->doneCurrent();
+            viewport->invalidate(DirtyFlag::Scene);
+        } catch (const std::exception &exception) {
+            viewport->doneCurrent();
+            QMessageBox::critical(nullptr, "Error", exception.what());
+        }
+
+        // TODO: update model statistics panel
+        hideProgress();
+        _loading = false;
+    });
+    timer->start(50);
+}
+
+void MenuBar::showProgress(int percent, const QString &text) {
+    if (_progressBar == nullptr) {
+        _progressBar = new QProgressBar;
+        _progressBar->setRange(0, 100);
+        _window.statusBar()->addPermanentWidget(_progressBar);
+    }
+    _progressBar->setFormat(text + " %p%");
+    _progressBar->setValue(percent);
+    _progressBar->show();
+}
+
+void MenuBar::hideProgress() {
+    if (_progressBar != nullptr) {
+        _progressBar->reset();
+        _progressBar->hide();
+    }
 }
 
 }  // namespace bgl
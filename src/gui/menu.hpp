@@ -1,17 +1,19 @@
 #ifndef GUI_MENU_BAR_HPP
 #define GUI_MENU_BAR_HPP
 
-#include <QMainWindow>
 #include <QMenuBar>
+#include <QProgressBar>
 
 #include <filesystem>
 
+#include "window.hpp"
+
 
 namespace bgl {
 
 class MenuBar : public QMenuBar {
  public:
-	explicit MenuBar(QMainWindow &window);  // NOLINT
+	explicit MenuBar(Window &window);  // NOLINT
 
 	MenuBar(MenuBar&&) = default;
 	MenuBar& operator=(MenuBar&&) = default;
@@ -22,12 +24,19 @@ class MenuBar : public QMenuBar {
 	virtual ~MenuBar() noexcept = default;
 
  protected:
+	/**
+	 * @brief Loads a model in the background and hands it to the window once it is ready.
+	 */
 	virtual void onLoadModel(const std::filesystem::path &path);
 
 	private:
 	void loadModel() noexcept;
+	void showProgress(int percent, const QString &text);
+	void hideProgress();
 
-	QMainWindow &_window;
+	Window &_window;
+	QProgressBar *_progressBar { nullptr };
+	bool _loading { false };
 };
 
 }  // namespace bgl
@@ -3,59 +3,30 @@
  * @brief A simple OpenGL Qt Viewport
  */
 #include "../gfx/gl.hpp"
+#include "../gfx/gl_debug.hpp"
 
 #include <QOpenGLWidget>
 
 #include <iostream>
-#include <ctime>     // std::clock()
 
 #include "viewport.hpp"
 
 
 namespace bgl {
 
-namespace {
-
-inline clock_t SDL_GetTicks()  {  // TODO(bkuolt)
-	return (std::clock() / static_cast<double>(CLOCKS_PER_SEC)) * 1000 *1000;
+Viewport::Viewport(QWidget *parent)
+    : QOpenGLWidget( parent) {
+    // keeps the last frame when paintGL() has nothing new to render
+    setUpdateBehavior(QOpenGLWidget::PartialUpdate);
 }
 
-class frame_counter final {
- public:
-	bool count() noexcept {
-		_delta = (SDL_GetTicks() - _timestamp_render) / 1000.0f;
-		_timestamp_render = SDL_GetTicks();
-		++_num_frames;
-
-		const bool is_new_second { SDL_GetTicks() - _timestamp_fps >= 1000 };
-		if (is_new_second) {
-			_timestamp_fps = SDL_GetTicks();
-			_fps = _num_frames;
-		}
-
-		return is_new_second;
-	}
-
-	size_t fps() const noexcept {
-		return  _fps;
-	}
-
-	double delta() const noexcept {
-		return _delta;
-	}
-
- private:
-	uint32_t _timestamp_fps { 0 };
-	uint32_t _timestamp_render { 0 };
-	size_t _num_frames { 0 };
-	size_t _fps { 0 };
-	double _delta { 0.0 };
-};
-
-}  // anonymous namespace
+void Viewport::invalidate(DirtyFlag flag) {
+    _dirty |= static_cast<unsigned>(flag);
+    update();  // Qt merges pending updates into one paint event
+}
 
-Viewport::Viewport(QWidget *parent)
-    : QOpenGLWidget( parent) {
+bool Viewport::isDirty(DirtyFlag flag) const noexcept {
+    return (_dirty & static_cast<unsigned>(flag)) != 0;
 }
 
 void Viewport::initializeGL() {
@@ -63,6 +34,7 @@ void Viewport::initializeGL() {
     if (GLEW_OK != error) {
         throw std::runtime_error { reinterpret_cast<const char*>(glewGetErrorString(error)) };
     }
+    EnableDebugOutput();
 
     glClearColor(0.3, 1.0, 0.3, 1.0f);
     std::cout << "initialized OpenGL: " << glGetString(GL_VERSION) << std::endl;
@@ -70,22 +42,34 @@ void Viewport::initializeGL() {
 
 void Viewport::resizeGL(int width, int height) {
     glViewport(0, 0, width, height);
+    _dirty |= static_cast<unsigned>(DirtyFlag::Size);  // the framebuffer was recreated
     std::cout << "resized windget to " << width << "x" << height << std::endl;
 }
 
 void Viewport::paintGL() {
-	static frame_counter frame_counter;
-    const bool changed { frame_counter.count() };
-    if (changed) {
-        // TODO(bkuolt): add TTF font rendering support
-          std::cout << "\r" << frame_counter.fps() << " FPS" << std::flush;
+    if (_dirty == 0) {
+        return;  // the framebuffer still holds the last frame
     }
 
+    const double delta { _frameTimer.begin() };
     makeCurrent();
-    on_render(frame_counter.delta());
+    _gpuTimer.collect(_gpuFrameTimer);  // of the previous frames
+    _gpuTimer.begin();
+    on_render(static_cast<float>(delta));
+    _gpuTimer.end();
+    _dirty = 0;
+    _frameTimer.end();
     // std::cout << "paintedGL()" << std::endl;
 }
 
+const FrameTimer& Viewport::getFrameTimer() const noexcept {
+    return _frameTimer;
+}
+
+const FrameTimer& Viewport::getGpuFrameTimer() const noexcept {
+    return _gpuFrameTimer;
+}
+
 void Viewport::on_render(float delta) {
     // nothing to do yet
 }
@@ -7,9 +7,26 @@
 
 #include <QOpenGLWidget>
 
+#include "frame_timer.hpp"
+#include "gpu_timer.hpp"
+
 
 namespace bgl {
 
+/**
+ * @brief State whose change requires a new frame.
+ */
+enum class DirtyFlag : unsigned {
+	Camera = 1u << 0,
+	Scene  = 1u << 1,
+	Size   = 1u << 2
+};
+
+/**
+ * @brief An OpenGL viewport that only renders frames when its state changed.
+ * @details Paint requests of Qt that are not preceded by invalidate(), e.g.
+ *          when the window is uncovered, show the last frame again.
+ */
 class Viewport : public QOpenGLWidget {
  public:
 	explicit Viewport(QWidget *parent);
@@ -21,13 +38,41 @@ class Viewport : public QOpenGLWidget {
 
 	virtual ~Viewport() noexcept = default;
 
+	/**
+	 * @brief Marks state as changed and schedules a frame.
+	 * @details Any number of calls before the next frame result in a single frame,
+	 *          so bursts of input events do not render more than once.
+	 */
+	void invalidate(DirtyFlag flag);
+	bool isDirty(DirtyFlag flag) const noexcept;
+
+	/**
+	 * @brief Returns the times the CPU took to submit the last frames.
+	 * @details The GPU may still be executing a frame after it was submitted.
+	 */
+	const FrameTimer& getFrameTimer() const noexcept;
+
+	/**
+	 * @brief Returns the times the GPU took to execute the last frames.
+	 * @details Results are read back without waiting, so they lag the CPU times by a few frames.
+	 */
+	const FrameTimer& getGpuFrameTimer() const noexcept;
+
  protected:
 	void initializeGL() override;
 	void resizeGL(int width, int height) override;
 	void paintGL() override;
 
  private:
+	 /**
+	  * @param delta The milliseconds since the previous frame.
+	  */
 	 virtual void on_render(float delta);
+
+	 unsigned _dirty { ~0u };  // DirtyFlags that changed since the last frame, all for the first one
+	 FrameTimer _frameTimer;     // CPU
+	 FrameTimer _gpuFrameTimer;
+	 GpuTimer _gpuTimer;
 };
 
 }  // namespace bgl
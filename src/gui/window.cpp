@@ -3,9 +3,13 @@
 #include <QScreen>
 #include <QStatusBar>
 #include <QGroupBox>
+#include <QLabel>
 
+#include <cstdlib>   // std::getenv()
 #include <future>    // std::call_once()
+#include <iomanip>   // std::setprecision()
 #include <memory>
+#include <sstream>
 #include <string>
 
 #include "window.hpp"
@@ -31,11 +35,32 @@ QSize get_desktop_size() {
 
 QStatusBar* get_dummy_status_bar() {
     static QStatusBar * statusBar { new QStatusBar };
-    statusBar->showMessage("TODO");
     return statusBar;
 }
 
-QMenuBar* get_dummy_menu_bar(QMainWindow &window) {
+/**
+ * @brief Returns the frame time statistics as a line of the status bar.
+ * @param name What was timed.
+ */
+std::string format_frame_times(const char *name, const FrameTimer::Statistics &statistics) {
+    std::ostringstream text;
+    if (statistics.frames == 0) {
+        text << name << " -";
+        return text.str();
+    }
+
+    text << std::fixed << std::setprecision(2)
+         << name << " " << statistics.avg << " ms"
+         << " (min " << statistics.min
+         << ", p50 " << statistics.p50
+         << ", p95 " << statistics.p95
+         << ", p99 " << statistics.p99
+         << ", max " << statistics.max
+         << " over " << statistics.frames << " frames)";
+    return text.str();
+}
+
+QMenuBar* get_dummy_menu_bar(Window &window) {
     static QMenuBar * menuBar { new MenuBar(window) };
     return menuBar;
 }
@@ -61,6 +86,36 @@ void Window::setViewport(Viewport *viewport) {
     _viewport->resize(get_desktop_size());
     _viewport->show();
     this->setCentralWidget(_viewport);
+
+    // shows the frame times next to the temporary messages
+    QLabel * const cpuTimes { new QLabel };
+    QLabel * const gpuTimes { new QLabel };
+    statusBar()->addPermanentWidget(cpuTimes);
+    statusBar()->addPermanentWidget(gpuTimes);
+    connect(_viewport, &QOpenGLWidget::frameSwapped, cpuTimes,
+            [viewport = _viewport, cpuTimes, gpuTimes, num_frames = std::size_t { 0 }] () mutable {
+        // frames are also swapped for repaints without a new frame
+        const FrameTimer &timer { viewport->getFrameTimer() };
+        if (timer.getFrameCount() == num_frames) {
+            return;
+        }
+        num_frames = timer.getFrameCount();
+        cpuTimes->setText(QString::fromStdString(format_frame_times("CPU submit", timer.getStatistics())));
+        gpuTimes->setText(QString::fromStdString(
+            format_frame_times("GPU", viewport->getGpuFrameTimer().getStatistics())));
+    });
+}
+
+Viewport* Window::getViewport() const noexcept {
+    return _viewport;
+}
+
+void Window::setModel(std::shared_ptr<Model> model) {
+    // nothing to display it with yet
+}
+
+void Window::addModel(std::shared_ptr<Model> model) {
+    setModel(model);
 }
 
 uvec2 Window::getSize() const noexcept {
@@ -71,4 +126,15 @@ void Window::render() {
 	// TODO(bkuolt)
 }
 
+/**
+ * @details Pre-transformed vertices allow drawing a model with glMultiDrawElementsIndirect(),
+ *          a SceneGraph stores meshes referenced by several nodes once.
+ */
+ImportOptions GetImportOptions() {
+    ImportOptions options;
+    options.buildTriangleBvh = true;  // for picking
+    options.preTransformVertices = std::getenv("BGL_KEEP_HIERARCHY") == nullptr;
+    return options;
+}
+
 }  // namespace bgl
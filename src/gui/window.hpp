@@ -1,15 +1,19 @@
 #ifndef GUI_WINDOW_HPP_
 #define GUI_WINDOW_HPP_
 
+#include <memory>
 #include <string>
 #include <QMainWindow>  // NOLINT
 
 #include "../gfx/gl.hpp"    // TODO(bkuolt): fix this
+#include "../gfx/model.hpp"  // bgl::ImportOptions
 #include "viewport.hpp"
 
 
 namespace bgl {
 
+class Model;
+
 /**
  * @brief A simple non-copyable, but moveable Window class
  */
@@ -27,11 +31,31 @@ class Window : public QMainWindow {
     uvec2 getSize() const noexcept;
     void render();
     void setViewport(Viewport *p);
+    Viewport* getViewport() const noexcept;
+
+    /**
+     * @brief Replaces the displayed model.
+     * @note Called with the OpenGL context of the viewport being current.
+     */
+    virtual void setModel(std::shared_ptr<Model> model);
+
+    /**
+     * @brief Adds a model next to the displayed ones.
+     * @note Called with the OpenGL context of the viewport being current.
+     */
+    virtual void addModel(std::shared_ptr<Model> model);
 
  protected:
 	Viewport *_viewport { nullptr };
 };
 
+/**
+ * @brief Returns the options the viewer loads models with.
+ * @details Set BGL_KEEP_HIERARCHY to keep the node hierarchy of the models in a
+ *          SceneGraph instead of baking the node transforms into the vertices.
+ */
+ImportOptions GetImportOptions();
+
 }  // namespace bgl
 
 #endif  // GUI_WINDOW_HPP_
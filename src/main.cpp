@@ -1,5 +1,6 @@
 #include <QApplication>
 #include <QMessageBox>
+#include <QSurfaceFormat>
 
 #include <csignal>
 #include <cstdlib>
@@ -13,6 +14,19 @@ static void signal_handler(int signal) {
 }
 
 int main(int argc, char *argv[]) {
+	// OpenGL errors are reported through the debug output of the context (see EnableDebugOutput()),
+	// a debug context reports all of them, but may be slower
+#ifdef BGL_CHECK_GL_ERRORS
+	const bool debug_context { true };
+#else
+	const bool debug_context { std::getenv("BGL_GL_DEBUG") != nullptr };
+#endif  // BGL_CHECK_GL_ERRORS
+	if (debug_context) {
+		QSurfaceFormat format { QSurfaceFormat::defaultFormat() };
+		format.setOption(QSurfaceFormat::DebugContext);
+		QSurfaceFormat::setDefaultFormat(format);
+	}
+
 	QApplication app(argc, argv);
 
 	if (argc != 2) {
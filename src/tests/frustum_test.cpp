@@ -0,0 +1,169 @@
+/**
+ * @file frustum_test.cpp
+ * @brief Checks the SSE2 culling of Frustum::cull() against a scalar test of the box corners.
+ */
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+#include "../gfx/frustum.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr float margin { 1e-3f };  // boxes closer to a plane are left out, rounding may differ there
+
+mat4 get_view_projection() {
+    const mat4 projection { glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.5f, 100.0f) };
+    const mat4 view { glm::lookAt(vec3 { 3.0f, 4.0f, 10.0f }, vec3 { 0.0f }, vec3 { 0.0f, 1.0f, 0.0f }) };
+    return projection * view;
+}
+
+/**
+ * @brief The planes of a view projection matrix, pointing inwards and normalized.
+ */
+std::array<vec4, 6> get_planes(const mat4 &viewProjection) {
+    const mat4 rows { glm::transpose(viewProjection) };
+    std::array<vec4, 6> planes;
+    for (int i = 0; i < 3; ++i) {
+        planes[2 * i] = rows[3] + rows[i];
+        planes[2 * i + 1] = rows[3] - rows[i];
+    }
+    for (vec4 &plane : planes) {
+        plane /= glm::length(vec3 { plane });
+    }
+    return planes;
+}
+
+/**
+ * @brief Returns the signed distance of the corner of a box that is farthest inside a plane.
+ */
+float get_max_distance(const vec4 &plane, const vec3 &center, const vec3 &extents) {
+    float distance { std::numeric_limits<float>::lowest() };
+    for (int corner = 0; corner < 8; ++corner) {
+        const vec3 sign { corner & 1 ? 1.0f : -1.0f, corner & 2 ? 1.0f : -1.0f, corner & 4 ? 1.0f : -1.0f };
+        distance = std::max(distance, glm::dot(vec3 { plane }, center + sign * extents) + plane.w);
+    }
+    return distance;
+}
+
+/**
+ * @brief Returns the signed distance of the corner of a box that is farthest outside a plane.
+ */
+float get_min_distance(const vec4 &plane, const vec3 &center, const vec3 &extents) {
+    return -get_max_distance(-plane, center, extents);
+}
+
+struct test_box {
+    vec3 center;
+    vec3 extents;
+};
+
+/**
+ * @brief Random boxes around the frustum, some of them centered on one of its planes.
+ */
+std::vector<test_box> create_boxes(const std::array<vec4, 6> &planes, std::size_t count) {
+    std::mt19937 generator { 3 };
+    std::uniform_real_distribution<float> position { -40.0f, 40.0f };
+    std::uniform_real_distribution<float> extent { 0.01f, 4.0f };
+    std::uniform_int_distribution<std::size_t> plane_index { 0, planes.size() - 1 };
+
+    std::vector<test_box> boxes(count);
+    for (std::size_t i = 0; i < count; ++i) {
+        test_box &box { boxes[i] };
+        box.center = vec3 { position(generator), position(generator), position(generator) * 2.0f - 40.0f };
+        box.extents = vec3 { extent(generator), extent(generator), extent(generator) };
+        if (i % 3 == 0) {  // straddles a plane
+            const vec4 &plane { planes[plane_index(generator)] };
+            box.center -= vec3 { plane } * (glm::dot(vec3 { plane }, box.center) + plane.w);
+        }
+    }
+    return boxes;
+}
+
+/**
+ * @brief Returns whether the box is not completely outside any of the planes,
+ *        or std::nullopt if it is too close to a plane to tell.
+ */
+std::optional<bool> is_visible(const std::array<vec4, 6> &planes, const test_box &box) {
+    for (const vec4 &plane : planes) {
+        const float distance { get_max_distance(plane, box.center, box.extents) };
+        if (std::abs(distance) < margin) {
+            return std::nullopt;
+        }
+        if (distance < 0.0f) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_cull() {
+    const mat4 VP { get_view_projection() };
+    const std::array<vec4, 6> planes { get_planes(VP) };
+    const std::vector<test_box> boxes { create_boxes(planes, 4099) };  // the last 3 take the scalar path
+
+    BoxArray array;
+    for (const test_box &box : boxes) {
+        array.push_back(BoundingBox { box.center, 2.0f * box.extents });
+    }
+
+    const Frustum frustum { VP };
+    std::vector<std::uint8_t> visible;
+    const std::size_t num_visible { frustum.cull(array, visible) };
+    CHECK(visible.size() == boxes.size());
+    CHECK(num_visible == static_cast<std::size_t>(std::count(visible.begin(), visible.end(), 1)));
+
+    std::size_t num_checked { 0 };
+    std::size_t num_straddling { 0 };
+    bool matches_reference { true };
+    bool matches_scalar { true };
+    for (std::size_t i = 0; i < boxes.size(); ++i) {
+        const test_box &box { boxes[i] };
+        matches_scalar = matches_scalar && (visible[i] != 0) == frustum.intersects(box.center, box.extents);
+
+        const std::optional<bool> reference { is_visible(planes, box) };
+        if (!reference.has_value()) {
+            continue;
+        }
+        ++num_checked;
+        matches_reference = matches_reference && (visible[i] != 0) == reference.value();
+
+        const bool straddles { std::any_of(planes.begin(), planes.end(), [&box] (const vec4 &plane) {
+            return get_min_distance(plane, box.center, box.extents) < 0.0f &&
+                   get_max_distance(plane, box.center, box.extents) > 0.0f;
+        }) };
+        num_straddling += straddles && reference.value();
+    }
+
+    CHECK(matches_reference);
+    CHECK(matches_scalar);
+    CHECK(num_checked > boxes.size() * 9 / 10);
+    CHECK(num_straddling > 100);  // visible boxes that cross a plane are tested, too
+    CHECK(num_visible > 100 && num_visible < boxes.size() - 100);
+}
+
+void test_empty() {
+    const Frustum frustum { get_view_projection() };
+    std::vector<std::uint8_t> visible(3, 1);
+    CHECK(frustum.cull(BoxArray {}, visible) == 0);
+    CHECK(visible.empty());
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    bgl::test_cull();
+    bgl::test_empty();
+    return bgl::test::report("frustum_test");
+}
@@ -0,0 +1,143 @@
+/**
+ * @file mesh_optimizer_test.cpp
+ * @brief Checks that the vertex cache optimization keeps the mesh and does not make it worse.
+ */
+#include <algorithm>
+#include <array>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+#include "../gfx/mesh_optimizer.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+using triangle = std::array<GLuint, 3>;
+
+constexpr GLuint grid_size { 64 };  // vertices per side
+
+/**
+ * @brief Returns the indices of a regular grid, row by row.
+ */
+std::vector<GLuint> create_grid() {
+    std::vector<GLuint> indices;
+    for (GLuint y = 0; y + 1 < grid_size; ++y) {
+        for (GLuint x = 0; x + 1 < grid_size; ++x) {
+            const GLuint corner { y * grid_size + x };
+            indices.insert(indices.end(), { corner, corner + 1, corner + grid_size });
+            indices.insert(indices.end(), { corner + 1, corner + grid_size + 1, corner + grid_size });
+        }
+    }
+    return indices;
+}
+
+/**
+ * @brief Shuffles the triangles like the scanned meshes come out of Assimp.
+ */
+std::vector<GLuint> shuffle(const std::vector<GLuint> &indices) {
+    std::vector<triangle> triangles;
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        triangles.push_back({ indices[i], indices[i + 1], indices[i + 2] });
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937 { 7 });
+
+    std::vector<GLuint> shuffled;
+    for (const triangle &t : triangles) {
+        shuffled.insert(shuffled.end(), t.begin(), t.end());
+    }
+    return shuffled;
+}
+
+/**
+ * @brief Returns the triangles with their first corner rotated to the smallest index, sorted.
+ * @details Rotating keeps the winding, so equal results mean equal front faces.
+ */
+std::vector<triangle> get_triangles(const std::vector<GLuint> &indices) {
+    std::vector<triangle> triangles;
+    for (std::size_t i = 0; i < indices.size(); i += 3) {
+        triangle t { indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.push_back(t);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+void test_vertex_cache(const std::vector<GLuint> &input) {
+    constexpr std::size_t num_vertices { grid_size * grid_size };
+    std::vector<GLuint> indices { input };
+    OptimizeVertexCache(indices, num_vertices);
+
+    CHECK(indices.size() == input.size());
+    CHECK(get_triangles(indices) == get_triangles(input));  // a permutation of the triangles
+
+    for (const std::size_t cache_size : { 16u, 32u }) {
+        const float before { AnalyzeVertexCache(input, num_vertices, cache_size).getACMR() };
+        const float after { AnalyzeVertexCache(indices, num_vertices, cache_size).getACMR() };
+        CHECK(after <= before);
+    }
+}
+
+void test_shuffled_grid() {
+    const std::vector<GLuint> input { shuffle(create_grid()) };
+    test_vertex_cache(input);
+
+    // a random order transforms almost every corner, an optimized grid less than one vertex per triangle
+    std::vector<GLuint> indices { input };
+    OptimizeVertexCache(indices, grid_size * grid_size);
+    CHECK(AnalyzeVertexCache(input, grid_size * grid_size).getACMR() > 2.0f);
+    CHECK(AnalyzeVertexCache(indices, grid_size * grid_size).getACMR() < 1.0f);
+}
+
+void test_ordered_grid() {
+    test_vertex_cache(create_grid());
+}
+
+void test_empty_mesh() {
+    std::vector<GLuint> indices;
+    OptimizeVertexCache(indices, 0);
+    CHECK(indices.empty());
+}
+
+void test_vertex_fetch() {
+    std::vector<Vertex> vertices(grid_size * grid_size + 1);  // the last vertex is not referenced
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        vertices[i].position = vec3 { static_cast<float>(i), 0.0f, 0.0f };
+    }
+    const std::vector<Vertex> input_vertices { vertices };
+    const std::vector<GLuint> input_indices { shuffle(create_grid()) };
+
+    std::vector<GLuint> indices { input_indices };
+    OptimizeVertexFetch(vertices, indices);
+    CHECK(vertices.size() == input_vertices.size() - 1);
+
+    // the same corners in the same order, only renumbered by first use
+    GLuint next { 0 };
+    bool first_use_order { true };
+    bool same_positions { true };
+    for (std::size_t i = 0; i < indices.size(); ++i) {
+        if (indices[i] == next) {
+            ++next;
+        } else if (indices[i] > next) {
+            first_use_order = false;
+        }
+        same_positions = same_positions && vertices[indices[i]].position == input_vertices[input_indices[i]].position;
+    }
+    CHECK(first_use_order);
+    CHECK(same_positions);
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    bgl::test_shuffled_grid();
+    bgl::test_ordered_grid();
+    bgl::test_empty_mesh();
+    bgl::test_vertex_fetch();
+    return bgl::test::report("mesh_optimizer_test");
+}
@@ -0,0 +1,43 @@
+/**
+ * @file test.hpp
+ * @brief Minimal checks for the CPU side unit tests.
+ */
+#ifndef TESTS_TEST_HPP_
+#define TESTS_TEST_HPP_
+
+#include <cstdlib>
+#include <iostream>
+
+
+namespace bgl::test {
+
+inline int& failures() noexcept {
+    static int failures { 0 };
+    return failures;
+}
+
+inline void check(bool condition, const char *expression, const char *file, int line) {
+    if (!condition) {
+        std::cout << file << ":" << line << ": check failed: " << expression << std::endl;
+        ++failures();
+    }
+}
+
+/**
+ * @brief Prints the result of a test program.
+ * @return The exit code of the test program.
+ */
+inline int report(const char *name) {
+    if (failures() != 0) {
+        std::cout << name << ": " << failures() << " checks failed" << std::endl;
+        return EXIT_FAILURE;
+    }
+    std::cout << name << ": passed" << std::endl;
+    return EXIT_SUCCESS;
+}
+
+}  // namespace bgl::test
+
+#define CHECK(condition) ::bgl::test::check((condition), #condition, __FILE__, __LINE__)
+
+#endif  // TESTS_TEST_HPP_
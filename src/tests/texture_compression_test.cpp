@@ -0,0 +1,132 @@
+/**
+ * @file texture_compression_test.cpp
+ * @brief Round trips known blocks through the BC1/BC3 encoder and the reference decoder.
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <vector>
+
+#include "test.hpp"
+#include "../gfx/texture_compression.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+using rgba = MipLevel::rgba;
+
+MipLevel make_level(std::uint32_t width, std::uint32_t height, rgba (*texel)(std::uint32_t x, std::uint32_t y)) {
+    MipLevel level { width, height, {} };
+    for (auto y = 0u; y < height; ++y) {
+        for (auto x = 0u; x < width; ++x) {
+            level.texels.push_back(texel(x, y));
+        }
+    }
+    return level;
+}
+
+MipLevel round_trip(const MipLevel &level, BlockFormat expected_format) {
+    const CompressedImage compressed { CompressImage({ level }) };
+    CHECK(compressed.format == expected_format);
+    CHECK(compressed.levels.size() == 1);
+    CHECK(compressed.levels[0].size() == GetCompressedSize(expected_format, level.width, level.height));
+    return DecompressLevel(compressed.format, compressed.levels[0], level.width, level.height);
+}
+
+int get_max_error(const MipLevel &a, const MipLevel &b, int channel) {
+    int error { 0 };
+    for (std::size_t i = 0; i < a.texels.size(); ++i) {
+        error = std::max(error, std::abs(a.texels[i][channel] - b.texels[i][channel]));
+    }
+    return error;
+}
+
+/**
+ * @brief Colors that can be represented in RGB565 survive exactly.
+ */
+void test_solid_blocks() {
+    for (const rgba color : { rgba { 0, 0, 0, 255 }, rgba { 255, 255, 255, 255 }, rgba { 255, 0, 0, 255 },
+                              rgba { 0, 255, 0, 255 }, rgba { 0, 0, 255, 255 }, rgba { 132, 130, 99, 255 } }) {
+        MipLevel level { 4, 4, std::vector<rgba>(16, color) };
+        const MipLevel decoded { round_trip(level, BlockFormat::BC1) };
+        CHECK(decoded.texels == level.texels);
+    }
+}
+
+/**
+ * @brief A block with 4 evenly spaced colors stays within the inset of the endpoints.
+ */
+void test_palette_block() {
+    const MipLevel level { make_level(4, 4, [] (std::uint32_t x, std::uint32_t) {
+        constexpr std::uint8_t reds[4] { 0, 85, 170, 255 };
+        return rgba { reds[x], 0, 0, 255 };
+    }) };
+    const MipLevel decoded { round_trip(level, BlockFormat::BC1) };
+    CHECK(get_max_error(level, decoded, 0) <= 255 / 16 + 4);  // inset and 565 rounding
+    CHECK(get_max_error(level, decoded, 1) == 0);
+    CHECK(get_max_error(level, decoded, 2) == 0);
+}
+
+/**
+ * @brief Gradients along a line through color space are reproduced closely,
+ *        also when channels fall while others rise.
+ */
+void test_gradient() {
+    const MipLevel level { make_level(16, 16, [] (std::uint32_t x, std::uint32_t y) {
+        const auto value { static_cast<std::uint8_t>(x * 12 + y * 4) };
+        return rgba { value, static_cast<std::uint8_t>(255 - value), static_cast<std::uint8_t>(value / 2), 255 };
+    }) };
+    const MipLevel decoded { round_trip(level, BlockFormat::BC1) };
+    for (int channel = 0; channel < 3; ++channel) {
+        CHECK(get_max_error(level, decoded, channel) <= 12);
+    }
+    CHECK(get_max_error(level, decoded, 3) == 0);
+}
+
+/**
+ * @brief Alpha is stored with 8 levels per block in BC3.
+ */
+void test_alpha_block() {
+    const MipLevel level { make_level(4, 4, [] (std::uint32_t x, std::uint32_t y) {
+        return rgba { 200, 100, 50, static_cast<std::uint8_t>((y * 4 + x) * 17) };
+    }) };
+    const MipLevel decoded { round_trip(level, BlockFormat::BC3) };
+    CHECK(get_max_error(level, decoded, 3) <= 255 / 14 + 1);  // half the distance of two levels
+    for (int channel = 0; channel < 3; ++channel) {
+        CHECK(get_max_error(level, decoded, channel) <= 4);  // 565 quantization
+    }
+
+    const MipLevel cutout { make_level(4, 4, [] (std::uint32_t x, std::uint32_t) {
+        return rgba { 10, 20, 30, static_cast<std::uint8_t>(x < 2 ? 0 : 255) };
+    }) };
+    CHECK(get_max_error(cutout, round_trip(cutout, BlockFormat::BC3), 3) == 0);
+}
+
+/**
+ * @brief Levels that are not a multiple of 4 are padded by the encoder and cropped by the decoder.
+ */
+void test_partial_blocks() {
+    const MipLevel level { make_level(5, 3, [] (std::uint32_t x, std::uint32_t) {
+        return rgba { static_cast<std::uint8_t>(x * 40), static_cast<std::uint8_t>(200 - x * 40), 0, 255 };
+    }) };
+    const MipLevel decoded { round_trip(level, BlockFormat::BC1) };
+    CHECK(decoded.width == 5);
+    CHECK(decoded.height == 3);
+    CHECK(decoded.texels.size() == 15);
+    CHECK(get_max_error(level, decoded, 0) <= 12);
+    CHECK(get_max_error(level, decoded, 1) <= 12);
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    bgl::test_solid_blocks();
+    bgl::test_palette_block();
+    bgl::test_gradient();
+    bgl::test_alpha_block();
+    bgl::test_partial_blocks();
+    return bgl::test::report("texture_compression_test");
+}
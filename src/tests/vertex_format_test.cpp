@@ -0,0 +1,102 @@
+/**
+ * @file vertex_format_test.cpp
+ * @brief Checks that textured meshes quantize within the error the importer accepts.
+ */
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+#include "test.hpp"
+#include "../gfx/vertex_format.hpp"
+
+
+namespace bgl {
+
+namespace {
+
+constexpr float max_texcoords_error { 1.0f / 8192 };  // as in importer.cpp
+
+/**
+ * @brief Returns random vertices with UVs in [min, max].
+ */
+std::vector<Vertex> create_vertices(float min, float max) {
+    std::mt19937 generator { 11 };
+    std::uniform_real_distribution<float> position { -10.0f, 10.0f };
+    std::uniform_real_distribution<float> texcoords { min, max };
+
+    std::vector<Vertex> vertices(4096);
+    for (Vertex &vertex : vertices) {
+        vertex.position = vec3 { position(generator), position(generator), position(generator) };
+        vertex.normal = glm::normalize(vec3 { position(generator), position(generator), position(generator) });
+        vertex.texcoords = vec2 { texcoords(generator), texcoords(generator) };
+    }
+    vertices.front().texcoords = vec2 { min };  // the UV bounds are hit exactly
+    vertices.back().texcoords = vec2 { max };
+    return vertices;
+}
+
+/**
+ * @brief Decodes the texture coordinates like the vertex shaders do.
+ */
+vec2 decode_texcoords(const CompactVertex &vertex, const VertexQuantization &quantization) {
+    return quantization.texcoordOffset + quantization.texcoordScale * vec2 { vertex.texcoords[0] / 65535.0f,
+                                                                             vertex.texcoords[1] / 65535.0f };
+}
+
+void test_texcoords(float min, float max) {
+    const std::vector<Vertex> vertices { create_vertices(min, max) };
+    const CompactVertices compact { CompressVertices(vertices.data(), vertices.size()) };
+    CHECK(compact.vertices.size() == vertices.size());
+    CHECK(compact.error.texcoords <= max_texcoords_error);
+
+    float error { 0.0f };
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const vec2 difference { glm::abs(decode_texcoords(compact.vertices[i], compact.quantization) -
+                                         vertices[i].texcoords) };
+        error = std::max({ error, difference.x, difference.y });
+    }
+    CHECK(error <= compact.error.texcoords + 1e-6f);  // the reported error is what the shader sees
+}
+
+void test_constant_texcoords() {
+    std::vector<Vertex> vertices { create_vertices(0.0f, 1.0f) };
+    for (Vertex &vertex : vertices) {
+        vertex.texcoords = vec2 { 0.5f, 0.25f };
+    }
+    const CompactVertices compact { CompressVertices(vertices.data(), vertices.size()) };
+    CHECK(compact.error.texcoords == 0.0f);
+}
+
+void test_positions() {
+    const std::vector<Vertex> vertices { create_vertices(0.0f, 1.0f) };
+    const CompactVertices compact { CompressVertices(vertices.data(), vertices.size()) };
+
+    float error { 0.0f };
+    for (std::size_t i = 0; i < vertices.size(); ++i) {
+        const vec3 difference { glm::abs(DecodePosition(compact.vertices[i], compact.quantization) -
+                                         vertices[i].position) };
+        error = std::max({ error, difference.x, difference.y, difference.z });
+    }
+    CHECK(error == compact.error.position);  // decoded as when the error was measured
+    CHECK(error <= 1e-4f * 20.0f);
+}
+
+void test_empty_mesh() {
+    const CompactVertices compact { CompressVertices(nullptr, 0) };
+    CHECK(compact.vertices.empty());
+}
+
+}  // anonymous namespace
+
+}  // namespace bgl
+
+int main() {
+    bgl::test_texcoords(0.0f, 1.0f);     // a single atlas
+    bgl::test_texcoords(-4.0f, 4.0f);    // a tiled texture
+    bgl::test_texcoords(10.0f, 10.5f);   // far from the origin, half floats only had a step of 2^-7
+    bgl::test_constant_texcoords();
+    bgl::test_positions();
+    bgl::test_empty_mesh();
+    return bgl::test::report("vertex_format_test");
+}
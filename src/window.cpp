@@ -2,11 +2,15 @@
 
 #include <QApplication>
 #include <QKeyEvent>
+#include <QMouseEvent>
+#include <QStatusBar>
 #include <QWheelEvent>
 #include <QOpenGLFramebufferObject>  // QOpenGLFramebufferObjectFormat
 
 #include <algorithm>  // std::max()
 #include <memory>     // std::shared_ptr
+#include <optional>
+#include <sstream>
 
 #include "window.hpp"
 
@@ -14,29 +18,70 @@
 #include "gfx/box.hpp"
 #include "gfx/grid.hpp"
 #include "gfx/camera.hpp"
+#include "gfx/picking.hpp"
+#include "gfx/scene.hpp"
+#include "gfx/state_tracker.hpp"
+#include "gfx/stream_buffer.hpp"
 
 
 namespace bgl {
 
 namespace {
 
+constexpr float model_spacing { 0.25f };  // between models placed side by side
+
 struct {
-	std::shared_ptr<Model> model;
+	Scene scene;
 	std::shared_ptr<Grid> grid;
 	ArcBall camera;
 	std::shared_ptr<Box> box;
-} Scene;
+	mat4 boxTransform { 1.0f };  // of the model the box belongs to
+	std::optional<Scene::Id> selected;
+} Viewer;
+
+/**
+ * @brief Frames the whole scene with the box and moves the grid below it.
+ */
+void frame_scene() {
+	const BoundingBox bounds { Viewer.scene.getBoundingBox() };
+	Viewer.selected.reset();
+	Viewer.box = std::make_shared<Box>(bounds);
+	Viewer.boxTransform = mat4 { 1.0f };
+
+	Viewer.grid = std::make_shared<Grid>(0.125, 40);
+	Viewer.grid->translate(vec3 { 0.0, bounds.getMin().y, 0.0 });
+	Viewer.camera.setFocus(bounds.getCenter());
+}
 
-void set_up_scene(const std::filesystem::path &path) {
-	Scene.model = LoadModel(path);
-	Scene.camera.setFocus({ 0.0, 0.0, 0.0 });
-	Scene.camera.setPosition({ 0.0, 1.0, 2.0 });
+void set_model(std::shared_ptr<Model> model) {
+	Viewer.scene.clear();
+	Viewer.scene.add(model);
+	frame_scene();
+}
 
-	Scene.box = std::make_shared<Box>(Scene.model->getBoundingBox());
+/**
+ * @brief Places a model right of the scene with its bottom on the grid.
+ */
+void add_model(std::shared_ptr<Model> model) {
+	if (Viewer.scene.empty()) {
+		set_model(model);
+		return;
+	}
+
+	const BoundingBox bounds { Viewer.scene.getBoundingBox() };
+	const BoundingBox &box { model->getBoundingBox() };
+	const vec3 offset {
+		bounds.getMax().x + model_spacing - box.getMin().x,
+		bounds.getMin().y - box.getMin().y,
+		bounds.getCenter().z - box.getCenter().z
+	};
+	Viewer.scene.add(model, glm::translate(offset));
+	frame_scene();
+}
 
-	Scene.grid = std::make_shared<Grid>(0.125, 40);
-	const vec3 v { 0.0, -Scene.model->getBoundingBox().getSize().y / 2.0, 0.0 };
-	Scene.grid->translate(v);
+void set_up_scene(const std::filesystem::path &path) {
+	set_model(LoadModel(path, GetImportOptions()));
+	Viewer.camera.setPosition({ 0.0, 1.0, 2.0 });
 
 	glEnable(GL_DEPTH_TEST);
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -74,10 +119,12 @@ void GLViewport::on_render(float delta) {
         initialized = true;
     }
 
+    StateTracker::instance().beginFrame();
+    StreamBuffer::instance().beginFrame();
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    const mat4 PV { Scene.camera.matrix() };
-    Scene.grid->render(PV);
-    Scene.box->render(PV);
+    const mat4 PV { Viewer.camera.matrix() };
+    Viewer.grid->render(PV);
+    Viewer.box->render(PV * Viewer.boxTransform);
 
     static DirectionalLight light {
         .direction = vec3 { -1.0, -1.0, -1.0 },
@@ -85,7 +132,7 @@ void GLViewport::on_render(float delta) {
         .ambient = vec3 { 0.2f, 0.2f, 0.2f }
     };
 
-    Scene.model->render(PV, light);
+    Viewer.scene.render(PV, light);
 }
 
 /* ------------------------------------ SimpleWindow ------------------------------------ */
@@ -96,6 +143,14 @@ SimpleWindow::SimpleWindow(const std::string &title)
     this->show();
 }
 
+void SimpleWindow::setModel(std::shared_ptr<Model> model) {
+    set_model(model);
+}
+
+void SimpleWindow::addModel(std::shared_ptr<Model> model) {
+    add_model(model);
+}
+
 bool SimpleWindow::event(QEvent *event) {
     if (event->type()  == QEvent::KeyPress) {
         return keyEvent(reinterpret_cast<QKeyEvent*>(event));
@@ -111,34 +166,73 @@ bool SimpleWindow::keyEvent(QKeyEvent *event) {
         case Qt::Key_Escape:
             close();
             return true;
+        case Qt::Key_Delete:
+            if (!Viewer.selected) {
+                return true;
+            }
+            _viewport.makeCurrent();
+            Viewer.scene.remove(*Viewer.selected);
+            frame_scene();
+            _viewport.invalidate(DirtyFlag::Scene);
+            return true;
         case Qt::Key_Left:
-            Scene.camera.rotate(-rotation, 0);
+            Viewer.camera.rotate(-rotation, 0);
             break;
         case Qt::Key_Right:
-            Scene.camera.rotate(rotation, 0);
+            Viewer.camera.rotate(rotation, 0);
             break;
         case Qt::Key_Up:
-            Scene.camera.rotate(0, -rotation);
+            Viewer.camera.rotate(0, -rotation);
             break;
         case Qt::Key_Down:
-            Scene.camera.rotate(0, rotation);
+            Viewer.camera.rotate(0, rotation);
             break;
     default:
         return QMainWindow::event(event);
     }
 
-    _viewport.makeCurrent();
-    _viewport.update();
+    _viewport.invalidate(DirtyFlag::Camera);
     return true;
 }
 
+void SimpleWindow::mousePressEvent(QMouseEvent *event) {
+    if (event->button() != Qt::LeftButton || Viewer.scene.empty()) {
+        QMainWindow::mousePressEvent(event);
+        return;
+    }
+
+    const QPoint position { _viewport.mapFrom(this, event->pos()) };
+    const vec2 ndc {
+        2.0f * position.x() / _viewport.width() - 1.0f,
+        1.0f - 2.0f * position.y() / _viewport.height()
+    };
+    const std::optional<Scene::Hit> hit { Viewer.scene.pick(Unproject(Viewer.camera.matrix(), ndc)) };
+
+    _viewport.makeCurrent();
+    std::ostringstream message;
+    if (hit) {
+        message << "picked triangle " << hit->triangle << " of mesh " << hit->mesh
+                << " of model " << hit->id << " at " << hit->point;
+        const Scene::Entry &entry { Viewer.scene.get(hit->id) };
+        Viewer.selected = hit->id;
+        Viewer.box = std::make_shared<Box>(entry.model->getMeshes().at(hit->mesh)._boundingBox);
+        Viewer.boxTransform = hit->node == SceneGraph::none ? entry.transform :
+            entry.transform * entry.model->getSceneGraph()->getWorldTransform(hit->node);
+    } else {
+        message << "nothing picked";
+        frame_scene();
+    }
+    statusBar()->showMessage(QString::fromStdString(message.str()), 5000);
+
+    _viewport.invalidate(DirtyFlag::Scene);
+}
+
 void SimpleWindow::wheelEvent(QWheelEvent *event) {
     const float delta { (-event->angleDelta().y() / 120.0f) / 10.0f };  // TODO
-    const float zoom { std::max(Scene.camera.getZoom() + delta, 1.0f) };
-    Scene.camera.setZoom(zoom);
+    const float zoom { std::max(Viewer.camera.getZoom() + delta, 1.0f) };
+    Viewer.camera.setZoom(zoom);
 
-    _viewport.makeCurrent();
-    _viewport.update();
+    _viewport.invalidate(DirtyFlag::Camera);
 }
 
 }  // namespace bgl
@@ -3,7 +3,9 @@
  * @brief 
  */
 #include <QKeyEvent>
+#include <QMouseEvent>
 
+#include <memory>
 #include <string>
 
 #include "gui/gui.hpp"  // bgl::Window, bgl::Viewport
@@ -44,9 +46,16 @@ class SimpleWindow final : public Window {
 
 	virtual ~SimpleWindow() noexcept = default;
 
+	void setModel(std::shared_ptr<Model> model) override;
+	void addModel(std::shared_ptr<Model> model) override;
 	bool event(QEvent *event) override;
 	void wheelEvent(QWheelEvent *event) override;
 
+	/**
+	 * @brief Picks the triangle under the cursor and frames its mesh.
+	 */
+	void mousePressEvent(QMouseEvent *event) override;
+
     GLViewport _viewport;  // TODO
  private:
 	bool keyEvent(QKeyEvent *event);